@@ -60,6 +60,7 @@ workspace(_OPTIONS["solution-name"])
     openssl_lib_path = "%{root}/_build/target-deps/openssl/%{config}/lib"
     re2_lib_path = "%{root}/_build/target-deps/re2/%{config}/lib"
     cares_lib_path = "%{root}/_build/target-deps/c-ares/%{config}/lib"
+    zlib_include_path = "%{root}/_build/target-deps/zlib/%{config}/include"
     zlib_lib_path = "%{root}/_build/target-deps/zlib/%{config}/lib"
     gtest_include_path = "%{root}/_build/target-deps/gtest/%{config}/include"
     gtest_lib_path = "%{root}/_build/target-deps/gtest/%{config}/lib"
@@ -19,7 +19,16 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <thread>
+#include <utility>
+
+#include <google/protobuf/arena.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <zlib.h>
 
 #include "logger.h"
 #include "a2f_controller_client.h"
@@ -49,8 +58,9 @@ using grpc::health::v1::HealthCheckResponse;
     } while(0)
 
 const int TIMEOUT_SEC = 3;
+const size_t ARENA_RESET_INTERVAL = 256;
+const std::string EMOTION_AGGREGATE_KEY = "emotion_aggregate";
 const size_t SAMPLE_RATE = 16000;
-const size_t CHUNK_SIZE = SAMPLE_RATE * sizeof(int16_t);
 const std::vector<std::string> EMOTION_STATE_NAMES = {
     "amazement",
     "anger",
@@ -72,15 +82,8 @@ void SetContextDeadline(grpc::ClientContext &context) {
         std::chrono::system_clock::now() + std::chrono::seconds(TIMEOUT_SEC));
 }
 
-// Increase the deadline in the gRPC context before calling stream->Write, effectively setting a timeout for stream writes.
-bool WriteWithDeadline(grpc::ClientContext &context,
-    std::shared_ptr<grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream>> stream,
-    const AudioStream &request) {
-    SetContextDeadline(context);
-    return stream->Write(request);
-}
-
 // Increase the deadline in the gRPC context before calling stream->Read, effectively setting a timeout for stream reads.
+// NOTE: Only the reader touches the context; the upload runs on another thread and must not.
 bool ReadWithDeadline(grpc::ClientContext &context,
     std::shared_ptr<grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream>> stream,
     AnimationDataStream *response) {
@@ -88,10 +91,104 @@ bool ReadWithDeadline(grpc::ClientContext &context,
     return stream->Read(response);
 }
 
+grpc_compression_algorithm ToGrpcCompression(mace::CompressionMode mode) {
+    switch (mode) {
+    case mace::CompressionDeflate:
+        return GRPC_COMPRESS_DEFLATE;
+    case mace::CompressionGzip:
+        return GRPC_COMPRESS_GZIP;
+    default:
+        return GRPC_COMPRESS_NONE;
+    }
+}
+
+// gRPC does not report the size of compressed messages, so compress a copy the way it does.
+// Messages that do not shrink are sent as they are.
+size_t EstimateCompressedSize(google::protobuf::MessageLite const &message, mace::CompressionMode mode) {
+    std::string serialized = message.SerializeAsString();
+    uLongf compressedSize = compressBound(static_cast<uLong>(serialized.size()));
+    std::vector<Bytef> compressed(compressedSize);
+    if (compress2(compressed.data(), &compressedSize,
+        reinterpret_cast<const Bytef*>(serialized.data()), static_cast<uLong>(serialized.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return serialized.size();
+    }
+    // the gzip header and trailer are 12 bytes longer than the zlib ones
+    size_t size = compressedSize + (mode == mace::CompressionGzip ? 12 : 0);
+    return std::min(size, serialized.size());
+}
+
+// Runs the audio upload next to the response reader.
+// The thread is always joined before the stream is finished; when the reader gives up early,
+// the call is cancelled first so that a blocked Write returns.
+class StreamWriterThread {
+public:
+    StreamWriterThread(grpc::ClientContext &context, std::function<void()> writer)
+        : m_context(context), m_thread(writer) {}
+    ~StreamWriterThread() {
+        Cancel();
+    }
+
+    void Join() {
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    void Cancel() {
+        if (m_thread.joinable()) {
+            m_context.TryCancel();
+            m_thread.join();
+        }
+    }
+
+private:
+    grpc::ClientContext &m_context;
+    std::thread m_thread;
+};
+
 }
 
 namespace mace {
 
+AceClientStatus ClassifyStatus(grpc::Status const &status, AceClientStatus fallback) {
+    if (status.ok()) {
+        return AceClientStatus::OK;
+    }
+    std::string const &errorMessage = status.error_message();
+    // The error code did not accurately reflect the actual cause of the failure; we need to parse the error message to identify the correct issue.
+    if (errorMessage.find("Unauthenticated") != std::string::npos ||
+        errorMessage.find("no authorization was passed") != std::string::npos) {
+        // failed to open stateful work request: rpc error: code = Unauthenticated desc = invalid response from UAM
+        // or
+        // no authorization was passed in the metadata
+        return AceClientStatus::ERROR_UNAUTHENTICATED;
+    } else if (errorMessage.find("SSL_ERROR_SSL") != std::string::npos) {
+        // failed to connect to all addresses; last error: UNKNOWN: ipv4:xxx.xxx.xxx.xxx:port: Ssl handshake failed: SSL_ERROR_SSL: error:FFFFFFFF:SSL routines::wrong version number
+        return AceClientStatus::ERROR_SSL_HANDSHAKE;
+    } else if (errorMessage.find("Deadline Exceeded") != std::string::npos) {
+        // Deadline Exceeded
+        // Possible causes:
+        // - bad network connection
+        // - invalid server port
+        // - connecting to a https server using http:// protocol
+        return AceClientStatus::ERROR_CONNECTION;
+    } else if (errorMessage.find("Cloud credits expired") != std::string::npos) {
+        // failed to open stateful work request: rpc error: code = Unknown desc = Account 'xxx': Cloud credits expired - Please contact NVIDIA representatives
+        return AceClientStatus::ERROR_CREDITS_EXPIRED;
+    } else if (errorMessage.find("DNS resolution failed") != std::string::npos) {
+        // Failed. code: 14, reason: DNS resolution failed for domain.not.exist.com:443: C-ares status is not ARES_SUCCESS qtype=AAAA name=domain.not.exist.com is_balancer=0: Domain name not found
+        return AceClientStatus::ERROR_DNS_RESOLUTION;
+    } else if (errorMessage.find("Connection refused") != std::string::npos) {
+        // Failed. code: 14, reason: failed to connect to all addresses; last error: UNAVAILABLE: ipv4:127.0.0.127:4434: Connection refused
+        return AceClientStatus::ERROR_CONNECTION;
+    }
+    // The following is a list of known error types. However, the current error messages are vague and lack sufficient detail.
+    // The server should be updated to provide more informative error messages instead of a generic internal server error.
+    // - Invalid functionId:
+    //   Failed. code: 13, reason: failed to open stateful work request: rpc error: code = Internal desc = There was a server error trying to handle an exception
+    return fallback;
+}
+
 AceClientStatus A2FControllerHealthCheck(
     std::shared_ptr<Health::StubInterface> stub, std::string apiKey, std::string functionId) {
     grpc::ClientContext context;
@@ -110,40 +207,8 @@ AceClientStatus A2FControllerHealthCheck(
     HealthCheckResponse response;
     grpc::Status status = stub->Check(&context, request, &response);
     if (!status.ok()) {
-        std::string errorMessage = status.error_message();
-        LOG_ERROR("A2FControllerHealthCheck: Failed. code: " << status.error_code() << ", reason: " << errorMessage);
-        // The error code did not accurately reflect the actual cause of the failure; we need to parse the error message to identify the correct issue.
-        if (errorMessage.find("Unauthenticated") != std::string::npos ||
-            errorMessage.find("no authorization was passed") != std::string::npos) {
-            // failed to open stateful work request: rpc error: code = Unauthenticated desc = invalid response from UAM
-            // or
-            // no authorization was passed in the metadata
-            return AceClientStatus::ERROR_UNAUTHENTICATED;
-        } else if (errorMessage.find("SSL_ERROR_SSL") != std::string::npos) {
-            // failed to connect to all addresses; last error: UNKNOWN: ipv4:xxx.xxx.xxx.xxx:port: Ssl handshake failed: SSL_ERROR_SSL: error:FFFFFFFF:SSL routines::wrong version number
-            return AceClientStatus::ERROR_SSL_HANDSHAKE;
-        } else if (errorMessage.find("Deadline Exceeded") != std::string::npos) {
-            // Deadline Exceeded
-            // Possible causes:
-            // - bad network connection
-            // - invalid server port
-            // - connecting to a https server using http:// protocol
-            return AceClientStatus::ERROR_CONNECTION;
-        } else if (errorMessage.find("Cloud credits expired") != std::string::npos) {
-            // failed to open stateful work request: rpc error: code = Unknown desc = Account 'xxx': Cloud credits expired - Please contact NVIDIA representatives
-            return AceClientStatus::ERROR_CREDITS_EXPIRED;
-        } else if (errorMessage.find("DNS resolution failed") != std::string::npos) {
-            // Failed. code: 14, reason: DNS resolution failed for domain.not.exist.com:443: C-ares status is not ARES_SUCCESS qtype=AAAA name=domain.not.exist.com is_balancer=0: Domain name not found
-            return AceClientStatus::ERROR_DNS_RESOLUTION;
-        } else if (errorMessage.find("Connection refused") != std::string::npos) {
-            // Failed. code: 14, reason: failed to connect to all addresses; last error: UNAVAILABLE: ipv4:127.0.0.127:4434: Connection refused
-            return AceClientStatus::ERROR_CONNECTION;
-        }
-        // The following is a list of known error types. However, the current error messages are vague and lack sufficient detail.
-        // The server should be updated to provide more informative error messages instead of a generic internal server error.
-        // - Invalid functionId:
-        //   Failed. code: 13, reason: failed to open stateful work request: rpc error: code = Internal desc = There was a server error trying to handle an exception
-        return AceClientStatus::ERROR_UNKNOWN;
+        LOG_ERROR("A2FControllerHealthCheck: Failed. code: " << status.error_code() << ", reason: " << status.error_message());
+        return ClassifyStatus(status, AceClientStatus::ERROR_UNKNOWN);
     }
     LOG_DEBUG("A2FControllerHealthCheck: Ok!");
     return AceClientStatus::OK;
@@ -178,8 +243,55 @@ void A2FControllerClient::SetBlendshapeOffset(const char *key, float value) {
     m_blendshapeOffsets[key] = value;
 }
 
+bool IsValidChunkingOptions(ChunkingOptions const &options) {
+    return options.chunk_size > 0 && (options.mode != ChunkAdaptive || options.initial_chunk_size > 0);
+}
+
+AceClientStatus A2FControllerClient::SetChunkingOptions(ChunkingOptions const &options) {
+    if (!IsValidChunkingOptions(options)) {
+        return AceClientStatus::ERROR_INVALID_INPUT;
+    }
+    m_chunkingOptions = options;
+    return AceClientStatus::OK;
+}
+
+void A2FControllerClient::SetCompression(CompressionMode mode) {
+    m_compression = mode;
+}
+
+void A2FControllerClient::SetCompressionEstimate(size_t messages) {
+    m_compressionEstimate = messages;
+}
+
+RequestStats const &A2FControllerClient::GetLastRequestStats() const {
+    return m_lastRequestStats;
+}
+
 AceClientStatus A2FControllerClient::ProcessAudioStream(
     const int16_t *samples, size_t sample_count, AceEmotionState input_emotion_state, std::vector<AnimDataFrame> *out_frames) {
+    FrameCollector collector(out_frames);
+    return ProcessAudioStream(samples, sample_count, input_emotion_state, &collector);
+}
+
+AceClientStatus A2FControllerClient::ProcessAudioStream(
+    const int16_t *samples, size_t sample_count, AceEmotionState input_emotion_state, FrameReceiver *receiver) {
+    MemoryAudioSource audio(samples, sample_count);
+    return ProcessAudioStream(audio, input_emotion_state, receiver);
+}
+
+AceClientStatus A2FControllerClient::ProcessAudioStream(
+    AudioSource const &audio, AceEmotionState input_emotion_state, FrameReceiver *receiver) {
+    AceClientStatus status = processAudioStream(audio, input_emotion_state, receiver);
+    receiver->OnComplete(status);
+    return status;
+}
+
+AceClientStatus A2FControllerClient::processAudioStream(
+    AudioSource const &audio, AceEmotionState input_emotion_state, FrameReceiver *receiver) {
+    if (audio.GetSampleRate() != SAMPLE_RATE) {
+        LOG_ERROR("A2FControllerClient: Audio at " << audio.GetSampleRate() << "Hz; only " << SAMPLE_RATE << "Hz is accepted");
+        return AceClientStatus::ERROR_INVALID_INPUT;
+    }
     grpc::ClientContext context;
     if (!m_apiKey.empty()) {
       context.AddMetadata("authorization", "Bearer " + m_apiKey);
@@ -187,71 +299,44 @@ AceClientStatus A2FControllerClient::ProcessAudioStream(
     if (!m_functionId.empty()) {
       context.AddMetadata("function-id", m_functionId);
     }
+    if (m_compression != CompressionNone) {
+        context.set_compression_algorithm(ToGrpcCompression(m_compression));
+    }
     std::shared_ptr<grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream>> stream(m_stub->ProcessAudioStream(&context));
 
     LOG_DEBUG("A2FControllerClient: ProcessAudioStream Start");
-    {
-        // send header
-        AudioStream message;
-        AudioStreamHeader* stream_header = message.mutable_audio_stream_header();
-
-        buildAudioStreamHeader(stream_header);
-
-        CHECK_TRUE(WriteWithDeadline(context, stream, message), "Unable to write AudioStreamHeader.");
-        LOG_DEBUG("A2FControllerClient: AudioStreamHeader has been written");
-        LOG_DEBUG(stream_header);
-    }
-    {
-        // send audio buffer
-        const size_t totalBufferSize = sample_count * sizeof(int16_t); // total buffer size in bytes
-        const uint8_t* audioBufferPtr = reinterpret_cast<const uint8_t*>(samples);
-        // Cutting the audio into reasonable sized chunks.
-        for(size_t offset = 0; offset < totalBufferSize; offset += CHUNK_SIZE) {
-            const size_t currentChunkSize = (offset + CHUNK_SIZE <= totalBufferSize) ? CHUNK_SIZE : (totalBufferSize - offset);
-            AudioStream message;
-            auto audioWithEmotion = message.mutable_audio_with_emotion();
-            audioWithEmotion->set_audio_buffer(audioBufferPtr + offset, currentChunkSize);
-
-            auto emotionWithTimeCode = audioWithEmotion->add_emotions();
-            // time_code is set to the start timestamp of each chunk
-            // in the future, if we have emotion key frame enabled,
-            // we can cut the chunk according to the keyframe timestamp or a max chunk size
-            emotionWithTimeCode->set_time_code((float)offset/(float)SAMPLE_RATE);
-            auto emotion = emotionWithTimeCode->mutable_emotion();
-            emotion->insert({"amazement", input_emotion_state.amazement});
-            emotion->insert({"anger", input_emotion_state.anger});
-            emotion->insert({"cheekiness", input_emotion_state.cheekiness});
-            emotion->insert({"disgust", input_emotion_state.disgust});
-            emotion->insert({"fear", input_emotion_state.fear});
-            emotion->insert({"grief", input_emotion_state.grief});
-            emotion->insert({"joy", input_emotion_state.joy});
-            emotion->insert({"out_of_breath", input_emotion_state.out_of_breath});
-            emotion->insert({"pain", input_emotion_state.pain});
-            emotion->insert({"sadness", input_emotion_state.sadness});
-
-            CHECK_TRUE(WriteWithDeadline(context, stream, message), "Unable to write AudioWithEmotion.");
-        }
-        LOG_DEBUG("A2FControllerClient: AudioWithEmotion has been written");
-    }
-    {
-        // send end marker
-        AudioStream message;
-        message.mutable_end_of_audio();
-        CHECK_TRUE(WriteWithDeadline(context, stream, message), "Unable to write EndOfAudio.");
-        LOG_DEBUG("A2FControllerClient: EndOfAudio has been written");
-    }
-    CHECK_TRUE(stream->WritesDone(), "WritesDone failed.");
+    m_lastRequestStats = RequestStats();
+    // Upload and download run concurrently on the bidi stream, so frames are consumed as soon as
+    // the server emits them instead of after the whole audio has been sent.
+    AceClientStatus writeStatus = AceClientStatus::OK;
+    StreamWriterThread writer(context, [&]() {
+        writeStatus = writeAudioStream(stream, audio, input_emotion_state);
+    });
 
     // read response
     LOG_DEBUG("A2FControllerClient: Start to read response");
-    AnimationDataStream response;
+    // Responses are decoded on an arena, which is reset every ARENA_RESET_INTERVAL messages so that
+    // a long clip neither allocates each decoded sub-message on the heap nor keeps all of them alive.
+    google::protobuf::Arena arena;
+    AnimationDataStream *response = google::protobuf::Arena::Create<AnimationDataStream>(&arena);
+    EmotionAggregate *emotionAggregate = google::protobuf::Arena::Create<EmotionAggregate>(&arena);
+    size_t messagesOnArena = 0;
 
     // the header must be sent first
     LOG_DEBUG("A2FControllerClient: Reading response header");
-    CHECK_TRUE(ReadWithDeadline(context, stream, &response), "Unable to read the response header");
-    if (!response.has_animation_data_stream_header()) {
+    if (!ReadWithDeadline(context, stream, response)) {
+        // without a pre-flight health check, connection and authentication errors surface here
+        LOG_ERROR("A2FControllerClient: Unable to read the response header");
+        writer.Join();
+        grpc::Status status = stream->Finish();
+        LOG_DEBUG("A2FControllerClient: Bidi streaming RPC failed: " << status.error_message());
+        return status.ok() ? AceClientStatus::ERROR_UNKNOWN : ClassifyStatus(status, AceClientStatus::ERROR_UNKNOWN);
+    }
+    m_lastRequestStats.bytes_received += response->ByteSizeLong();
+    if (!response->has_animation_data_stream_header()) {
         // handle error
         LOG_ERROR("Response header is not sent as the first response message");
+        writer.Cancel();
         stream->Finish();
         return AceClientStatus::ERROR_UNEXPECTED_OUTPUT;
     }
@@ -259,36 +344,39 @@ AceClientStatus A2FControllerClient::ProcessAudioStream(
     // parse response header
     LOG_DEBUG("A2FControllerClient: Received AnimationDataStreamHeader");
     std::vector<std::string> blendshape_names;
-    auto responseHeader = response.animation_data_stream_header();
+    auto const &responseHeader = response->animation_data_stream_header();
     if (responseHeader.has_skel_animation_header()) {
-        auto skelAnimationHeader = responseHeader.skel_animation_header();
+        auto const &skelAnimationHeader = responseHeader.skel_animation_header();
         blendshape_names.clear();
         for(int i=0;i<skelAnimationHeader.blend_shapes_size();++i) {
             blendshape_names.push_back(skelAnimationHeader.blend_shapes(i));
         }
     }
+    receiver->OnHeader(blendshape_names, EMOTION_STATE_NAMES);
 
     // read response until end status is received
-    while(ReadWithDeadline(context, stream, &response)) {
-        if (response.has_animation_data()) {
+    while(ReadWithDeadline(context, stream, response)) {
+        m_lastRequestStats.bytes_received += response->ByteSizeLong();
+        if (response->has_animation_data()) {
             LOG_DEBUG("A2FControllerClient: Received AnimationData");
             std::vector<float> emotion_state;
 
-            auto animationData = response.animation_data();
+            auto const &animationData = response->animation_data();
             // parse metadata (emotino_aggregation)
-            auto metadata = animationData.metadata();
-            const std::string EMOTION_AGGREGATE_KEY = "emotion_aggregate";
-            if (metadata.find(EMOTION_AGGREGATE_KEY) != metadata.end()) {
-                const google::protobuf::Any& any_value = metadata.at(EMOTION_AGGREGATE_KEY);
+            auto const &metadata = animationData.metadata();
+            auto metadataIter = metadata.find(EMOTION_AGGREGATE_KEY);
+            if (metadataIter != metadata.end()) {
+                const google::protobuf::Any& any_value = metadataIter->second;
                 if (any_value.Is<EmotionAggregate>()) {
-                    EmotionAggregate emotionAggregate;
-                    any_value.UnpackTo(&emotionAggregate);
-
-                    if (emotionAggregate.a2f_smoothed_output_size() > 0) {
-                        auto emotion = emotionAggregate.a2f_smoothed_output(0).emotion();
-                        for (auto name : EMOTION_STATE_NAMES) {
-                            if (emotion.find(name) != emotion.end()) {
-                                emotion_state.push_back(emotion[name]);
+                    any_value.UnpackTo(emotionAggregate);
+
+                    if (emotionAggregate->a2f_smoothed_output_size() > 0) {
+                        auto const &emotion = emotionAggregate->a2f_smoothed_output(0).emotion();
+                        emotion_state.reserve(EMOTION_STATE_NAMES.size());
+                        for (auto const &name : EMOTION_STATE_NAMES) {
+                            auto emotionIter = emotion.find(name);
+                            if (emotionIter != emotion.end()) {
+                                emotion_state.push_back(emotionIter->second);
                             } else {
                                 emotion_state.push_back(0.0f);
                             }
@@ -306,28 +394,36 @@ AceClientStatus A2FControllerClient::ProcessAudioStream(
                 // the input audio buffer will be echo back from the server.
             }
             if (animationData.has_skel_animation()) {
-                auto skelAnimation = animationData.skel_animation();
+                auto const &skelAnimation = animationData.skel_animation();
                 // from the experiment there's only one element in this blend_shape_weights array.
-                for(auto blend_shape_weights : skelAnimation.blend_shape_weights()) {
+                std::vector<AnimDataFrame> frames;
+                frames.reserve(skelAnimation.blend_shape_weights_size());
+                for(auto const &blend_shape_weights : skelAnimation.blend_shape_weights()) {
                     AnimDataFrame animDataFrame;
                     animDataFrame.timestamp = blend_shape_weights.time_code();
-                    animDataFrame.blend_shape_names = blendshape_names;
-                    animDataFrame.emotion_state_names = EMOTION_STATE_NAMES;
                     animDataFrame.emotion_state = emotion_state;
                     animDataFrame.blend_shape_weights = std::vector<float>(blend_shape_weights.values().begin(), blend_shape_weights.values().end());
-                    out_frames->push_back(animDataFrame);
                     LOG_DEBUG("A2FControllerClient: timestamp: " << animDataFrame.timestamp);
+                    frames.push_back(std::move(animDataFrame));
+                }
+                // hand the frames over as soon as they are decoded
+                if (!frames.empty()) {
+                    receiver->OnFrames(std::move(frames));
                 }
             }
-        } else if (response.has_event()) {
+        } else if (response->has_event()) {
             LOG_DEBUG("A2FControllerClient: Received Event");
-        } else if (response.has_status()) {
+        } else if (response->has_status()) {
             // The status must be sent last and may be sent in between.
             // the comment in the proto definition didn't say how to check for the end of the response stream.
             // assuming the stream is terminated by ERROR or SUCCESS status code. INFO and WARNING might be sent in between.
-            auto status = response.status();
+            auto const &status = response->status();
+            if (status.code() != Status_Code::Status_Code_SUCCESS) {
+                receiver->OnStatus(status.code(), status.message());
+            }
             if (status.code() == Status_Code::Status_Code_ERROR) {
                 LOG_ERROR("A2FControllerClient: Received Error Status Code: " << status.message());
+                writer.Cancel();
                 stream->Finish();
                 return AceClientStatus::ERROR_UNEXPECTED_OUTPUT;
             }
@@ -343,19 +439,144 @@ AceClientStatus A2FControllerClient::ProcessAudioStream(
             );
         } else {
             // This should not happen. Likely theres a new type of message gets added. Please check the AnimationDataStream proto definition.
-            LOG_DEBUG("A2FControllerClient: Received Unknown Response");
+            LOG_ERROR("A2FControllerClient: Received Unknown Response");
+            writer.Cancel();
+            stream->Finish();
             return AceClientStatus::ERROR_UNEXPECTED_OUTPUT;
         }
+
+        if (++messagesOnArena == ARENA_RESET_INTERVAL) {
+            arena.Reset();
+            response = google::protobuf::Arena::Create<AnimationDataStream>(&arena);
+            emotionAggregate = google::protobuf::Arena::Create<EmotionAggregate>(&arena);
+            messagesOnArena = 0;
+        }
     }
+    writer.Join();
     grpc::Status status = stream->Finish();
     if (!status.ok()) {
         LOG_DEBUG("A2FControllerClient: Bidi streaming RPC failed: " << status.error_message());
-        return AceClientStatus::ERROR_CONNECTION;
+        return ClassifyStatus(status, AceClientStatus::ERROR_CONNECTION);
+    }
+    if (writeStatus != AceClientStatus::OK) {
+        return writeStatus;
     }
     LOG_DEBUG("A2FControllerClient: ProcessAudioStream End");
     return AceClientStatus::OK;
 }
 
+bool A2FControllerClient::writeMessage(
+    std::shared_ptr<grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream>> stream,
+    AudioStream const &message) {
+    size_t size = message.ByteSizeLong();
+    m_lastRequestStats.bytes_sent += size;
+    // compressing a copy costs as much as sending it, so only a few messages are estimated on request
+    bool sampled = m_compression == CompressionNone || m_lastRequestStats.sampled_messages < m_compressionEstimate;
+    if (sampled) {
+        m_lastRequestStats.compressed_bytes_sent +=
+            m_compression == CompressionNone ? size : EstimateCompressedSize(message, m_compression);
+        m_lastRequestStats.sampled_bytes_sent += size;
+        m_lastRequestStats.sampled_messages++;
+    }
+    return stream->Write(message);
+}
+
+AceClientStatus A2FControllerClient::writeAudioStream(
+    std::shared_ptr<grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream>> stream,
+    const int16_t *samples, size_t sample_count, AceEmotionState input_emotion_state) {
+    MemoryAudioSource audio(samples, sample_count);
+    return writeAudioStream(stream, audio, input_emotion_state);
+}
+
+AceClientStatus A2FControllerClient::writeAudioStream(
+    std::shared_ptr<grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream>> stream,
+    AudioSource const &audio, AceEmotionState input_emotion_state) {
+    {
+        // send header
+        AudioStream message;
+        AudioStreamHeader* stream_header = message.mutable_audio_stream_header();
+
+        buildAudioStreamHeader(stream_header);
+
+        CHECK_TRUE(writeMessage(stream, message), "Unable to write AudioStreamHeader.");
+        LOG_DEBUG("A2FControllerClient: AudioStreamHeader has been written");
+        LOG_DEBUG(stream_header);
+    }
+    {
+        // send audio buffer
+        // One message is reused for all chunks. The emotions are the same for every chunk, so the
+        // map is filled once and only the buffer and the time code change; the buffer keeps its capacity.
+        AudioStream message;
+        auto audioWithEmotion = message.mutable_audio_with_emotion();
+        auto emotionWithTimeCode = audioWithEmotion->add_emotions();
+        auto emotion = emotionWithTimeCode->mutable_emotion();
+        emotion->insert({"amazement", input_emotion_state.amazement});
+        emotion->insert({"anger", input_emotion_state.anger});
+        emotion->insert({"cheekiness", input_emotion_state.cheekiness});
+        emotion->insert({"disgust", input_emotion_state.disgust});
+        emotion->insert({"fear", input_emotion_state.fear});
+        emotion->insert({"grief", input_emotion_state.grief});
+        emotion->insert({"joy", input_emotion_state.joy});
+        emotion->insert({"out_of_breath", input_emotion_state.out_of_breath});
+        emotion->insert({"pain", input_emotion_state.pain});
+        emotion->insert({"sadness", input_emotion_state.sadness});
+
+        // Cutting the audio into reasonable sized chunks. Only one chunk of a source that is not
+        // in memory is read at a time.
+        const size_t sample_count = audio.GetSampleCount();
+        const int16_t *samples = audio.GetSamples();
+        size_t chunkSize = m_chunkingOptions.mode == ChunkAdaptive ?
+            std::min(m_chunkingOptions.initial_chunk_size, m_chunkingOptions.chunk_size) : m_chunkingOptions.chunk_size;
+        m_lastRequestStats.chunk_sizes.reserve(sample_count / chunkSize + 1);
+        for(size_t offset = 0; offset < sample_count; offset += chunkSize) {
+            if (m_chunkingOptions.mode == ChunkAdaptive && offset > 0) {
+                chunkSize = std::min(chunkSize * 2, m_chunkingOptions.chunk_size);
+            }
+            const size_t currentChunkSize = std::min(chunkSize, sample_count - offset);
+            m_lastRequestStats.chunk_sizes.push_back(currentChunkSize);
+            // assign() into the existing string; set_audio_buffer() may build a temporary string
+            std::string *buffer = audioWithEmotion->mutable_audio_buffer();
+            if (samples) {
+                buffer->assign(reinterpret_cast<const char*>(samples + offset), currentChunkSize * sizeof(int16_t));
+            } else {
+                buffer->resize(currentChunkSize * sizeof(int16_t));
+                size_t read = audio.Read(offset, reinterpret_cast<int16_t*>(&(*buffer)[0]), currentChunkSize);
+                CHECK_TRUE(read == currentChunkSize, "Unable to read the audio.");
+            }
+
+            // time_code is set to the start timestamp of each chunk
+            // in the future, if we have emotion key frame enabled,
+            // we can cut the chunk according to the keyframe timestamp or a max chunk size
+            emotionWithTimeCode->set_time_code((float)offset/(float)SAMPLE_RATE);
+
+            CHECK_TRUE(writeMessage(stream, message), "Unable to write AudioWithEmotion.");
+        }
+        LOG_DEBUG("A2FControllerClient: AudioWithEmotion has been written");
+    }
+    {
+        // send end marker
+        AudioStream message;
+        message.mutable_end_of_audio();
+        CHECK_TRUE(writeMessage(stream, message), "Unable to write EndOfAudio.");
+        LOG_DEBUG("A2FControllerClient: EndOfAudio has been written");
+    }
+    CHECK_TRUE(stream->WritesDone(), "WritesDone failed.");
+    return AceClientStatus::OK;
+}
+
+std::string A2FControllerClient::GetSerializedParameters() {
+    AudioStreamHeader stream_header;
+    buildAudioStreamHeader(&stream_header);
+    std::string bytes;
+    {
+        google::protobuf::io::StringOutputStream stream(&bytes);
+        google::protobuf::io::CodedOutputStream output(&stream);
+        output.SetSerializationDeterministic(true);
+        stream_header.SerializeToCodedStream(&output);
+    }
+    return bytes;
+}
+
 void A2FControllerClient::buildAudioStreamHeader(AudioStreamHeader* stream_header) {
     // Fill the information of AudioStreamHeader
 
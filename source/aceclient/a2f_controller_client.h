@@ -32,6 +32,7 @@
 #include "ace_grpc_cpp/nvidia_ace.services.a2f_controller.v1.grpc.pb.h"
 
 #include "aceclient/aceclient.h"
+#include "aceclient/audio_source.h"
 #include "aceclient/parameters.h"
 #include "aceclient/frame_receiver.h"
 
@@ -46,6 +47,48 @@ class TestA2FControllerClient_TestBuildAudioStreamHeader_Test;
 
 namespace mace {
 
+// one second of 16kHz audio
+const size_t DEFAULT_CHUNK_SIZE = 16000;
+const size_t DEFAULT_INITIAL_CHUNK_SIZE = 1600;
+
+enum ChunkMode {
+    // every chunk has chunk_size samples
+    ChunkFixed,
+    // starts with initial_chunk_size samples for an early first frame and doubles up to chunk_size
+    ChunkAdaptive,
+};
+
+// How the audio is cut into AudioWithEmotion messages. Sizes are in samples.
+struct ChunkingOptions {
+    ChunkMode mode = ChunkFixed;
+    size_t chunk_size = DEFAULT_CHUNK_SIZE;
+    size_t initial_chunk_size = DEFAULT_INITIAL_CHUNK_SIZE;
+};
+
+bool IsValidChunkingOptions(ChunkingOptions const &options);
+
+// gRPC message compression of the audio upload
+enum CompressionMode {
+    CompressionNone,
+    CompressionDeflate,
+    CompressionGzip,
+};
+
+struct RequestStats {
+    // the size of each audio chunk sent, in samples
+    std::vector<size_t> chunk_sizes;
+    // serialized size of the messages sent
+    size_t bytes_sent = 0;
+    // Estimated size after compression of the sampled messages, and their serialized size.
+    // Without compression every message is counted as it is; with it, only the first messages
+    // allowed by SetCompressionEstimate are compressed again to estimate, and none by default.
+    size_t compressed_bytes_sent = 0;
+    size_t sampled_bytes_sent = 0;
+    size_t sampled_messages = 0;
+    // serialized size of the messages received
+    size_t bytes_received = 0;
+};
+
 class A2FControllerClient {
 public:
     A2FControllerClient(
@@ -65,11 +108,35 @@ public:
         AceEmotionState input_emotion_state,
         std::vector<AnimDataFrame> *out_frames
     );
+    // Streams the animation to the receiver as it arrives. receiver->OnComplete() is called with
+    // the returned status before this function returns.
+    AceClientStatus ProcessAudioStream(
+        const int16_t *samples,
+        size_t sample_count,
+        AceEmotionState input_emotion_state,
+        FrameReceiver *receiver
+    );
+    // Uploads the audio block by block as it is read from the source, which must be at 16kHz.
+    AceClientStatus ProcessAudioStream(
+        AudioSource const &audio,
+        AceEmotionState input_emotion_state,
+        FrameReceiver *receiver
+    );
 
     void SetFaceParam(const char *key, float val);
     void SetEmotionPostProcessingParams(EmotionPostProcessingParameters &param);
     void SetBlendshapeMultiplier(const char *key, float value);
     void SetBlendshapeOffset(const char *key, float value);
+    AceClientStatus SetChunkingOptions(ChunkingOptions const &options);
+    void SetCompression(CompressionMode mode);
+    // Estimate the compressed size of up to this many messages of each request; 0 disables it.
+    // Diagnostic only: every estimated message is serialized and compressed a second time.
+    void SetCompressionEstimate(size_t messages);
+    // Valid once ProcessAudioStream has returned.
+    RequestStats const &GetLastRequestStats() const;
+    // The AudioStreamHeader of the current parameters, serialized with a stable order of the map
+    // entries so equal parameters give equal bytes.
+    std::string GetSerializedParameters();
 
 protected:
     std::shared_ptr<A2FControllerService::StubInterface> m_stub;
@@ -80,8 +147,35 @@ protected:
     google::protobuf::Map<std::string, float> m_faceParameters;
     google::protobuf::Map<std::string, float> m_blendshapeMultipliers;
     google::protobuf::Map<std::string, float> m_blendshapeOffsets;
+    ChunkingOptions m_chunkingOptions;
+    CompressionMode m_compression = CompressionNone;
+    size_t m_compressionEstimate = 0;
+    RequestStats m_lastRequestStats;
 
     void buildAudioStreamHeader(AudioStreamHeader* stream_header);
+    AceClientStatus processAudioStream(
+        AudioSource const &audio,
+        AceEmotionState input_emotion_state,
+        FrameReceiver *receiver
+    );
+    bool writeMessage(
+        std::shared_ptr<grpc::ClientReaderWriterInterface<
+            ::nvidia_ace::controller::v1::AudioStream, ::nvidia_ace::controller::v1::AnimationDataStream>> stream,
+        ::nvidia_ace::controller::v1::AudioStream const &message
+    );
+    AceClientStatus writeAudioStream(
+        std::shared_ptr<grpc::ClientReaderWriterInterface<
+            ::nvidia_ace::controller::v1::AudioStream, ::nvidia_ace::controller::v1::AnimationDataStream>> stream,
+        const int16_t *samples,
+        size_t sample_count,
+        AceEmotionState input_emotion_state
+    );
+    AceClientStatus writeAudioStream(
+        std::shared_ptr<grpc::ClientReaderWriterInterface<
+            ::nvidia_ace::controller::v1::AudioStream, ::nvidia_ace::controller::v1::AnimationDataStream>> stream,
+        AudioSource const &audio,
+        AceEmotionState input_emotion_state
+    );
 
 // allow tests/test_a2f_controller_client.cpp to verify the private member variables
 friend class ::TestA2FControllerClient_TestSetup_Test;
@@ -89,6 +183,9 @@ friend class ::TestA2FControllerClient_TestSetBlendshapeParameters_Test;
 friend class ::TestA2FControllerClient_TestBuildAudioStreamHeader_Test;
 };
 
+// Maps a failed gRPC status to AceClientStatus, or to the fallback when the cause is not recognized.
+AceClientStatus ClassifyStatus(grpc::Status const &status, AceClientStatus fallback);
+
 AceClientStatus A2FControllerHealthCheck(
     std::shared_ptr<grpc::Channel> channel, std::string apiKey, std::string functionId);
 AceClientStatus A2FControllerHealthCheck(
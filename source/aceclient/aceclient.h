@@ -31,4 +31,5 @@ typedef enum AceClientStatus {
   ERROR_DNS_RESOLUTION,
   ERROR_INVALID_INPUT,
   ERROR_UNEXPECTED_OUTPUT,
+  ERROR_CANCELLED,
 } AceClientStatus;
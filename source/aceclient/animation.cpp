@@ -21,8 +21,11 @@
 #include "animation.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <memory>
 #include <optional>
 #include <iostream>
 #include <system_error>
@@ -30,12 +33,74 @@
 #include <vector>
 #include <thread>
 
+#include "animation_track.h"
+#include "audio.h"
+#include "audio_source.h"
+#include "channel_pool.h"
+#include "clip_cache.h"
+#include "disk_cache.h"
 #include "frame_receiver.h"
+#include "hash.h"
+#include "health_cache.h"
 #include "logger.h"
 #include "parameters.h"
+#include "request_coalescer.h"
+#include "simd.h"
 
 #pragma warning(disable : 4244)
 
+namespace {
+    // Failures that leave the pooled channel in a doubtful state.
+    bool isConnectionError(AceClientStatus status) {
+        return status == AceClientStatus::ERROR_CONNECTION ||
+            status == AceClientStatus::ERROR_SSL_HANDSHAKE ||
+            status == AceClientStatus::ERROR_DNS_RESOLUTION;
+    }
+
+    // Failures of a broken stream rather than of the request itself.
+    bool isRetryable(AceClientStatus status) {
+        return status == AceClientStatus::ERROR_CONNECTION ||
+            status == AceClientStatus::ERROR_UNKNOWN;
+    }
+
+    // Interpolate the rows of the frames around a time into out, and return the number of values.
+    // Rows of different widths are not blended; the right one is used as is.
+    size_t sampleRows(
+        mace::ArrayView<const float> left, mace::ArrayView<const float> right, float t,
+        float *out, size_t capacity) {
+        if (right.size() > capacity) {
+            return right.size();
+        }
+        if (t > 0.0f && left.size() == right.size()) {
+            mace::Lerp(left.data(), right.data(), t, out, right.size());
+        }
+        else {
+            std::copy(right.begin(), right.end(), out);
+        }
+        return right.size();
+    }
+
+    // Completes a coalesced request when its leader returns or unwinds, so the waiters never hang;
+    // an exception leaves them with ERROR_UNKNOWN.
+    class CoalescedCompletion {
+    public:
+        explicit CoalescedCompletion(mace::RequestKey const &key) : m_key(key) {}
+        ~CoalescedCompletion() {
+            Complete(mace::CoalescedResult());
+        }
+
+        void Complete(mace::CoalescedResult const &result) {
+            if (!m_completed) {
+                m_completed = true;
+                mace::RequestCoalescer::Instance().Complete(m_key, result);
+            }
+        }
+
+    private:
+        mace::RequestKey m_key;
+        bool m_completed = false;
+    };
+}
 
 namespace mace {
 
@@ -57,197 +122,581 @@ namespace mace {
     }
 
     bool AnimationClient::HasAnimation(float seconds) {
-        return HasAnimation(GetFrameIndex(seconds));
+        auto current = GetTrack();
+        return current->GetFramesCount() > getFrameIndex(*current, seconds);
     }
 
     bool AnimationClient::HasAnimation(size_t frame_index) {
-        return frames.size() > frame_index;
+        return GetTrack()->GetFramesCount() > frame_index;
     }
 
     size_t AnimationClient::GetFrameIndex(float seconds) {
-        size_t frame_index = (size_t)std::ceil(seconds * framerate);
+        return getFrameIndex(*GetTrack(), seconds);
+    }
+
+    size_t AnimationClient::getFrameIndex(AnimationTrack const &current, float seconds) {
+        double position = getFramePosition(current, seconds);
+        if (current.HasTimeIndex()) {
+            // a time just past a frame due to rounding still finds that frame
+            position -= FRAME_POSITION_TOLERANCE;
+        }
+        size_t frame_index = (size_t)std::max(std::ceil(position), 0.0);
         return frame_index;
     }
 
+    double AnimationClient::getFramePosition(AnimationTrack const &current, float seconds) {
+        if (current.HasTimeIndex()) {
+            return std::max(current.GetFramePosition(seconds), 0.0);
+        }
+        // without timestamps, frames are at the framerate
+        return std::max(seconds * framerate, 0.0f);
+    }
+
     size_t AnimationClient::GetFramesCount() {
-        return frames.size();
+        return GetTrack()->GetFramesCount();
     }
 
     float AnimationClient::GetAnimationLength() {
-        return frames.size() / (float) framerate;
+        auto current = GetTrack();
+        if (current->HasTimeIndex()) {
+            return current->GetFramesCount() * current->GetFrameInterval();
+        }
+        return current->GetFramesCount() / (float) framerate;
     }
 
     AnimDataFrame AnimationClient::GetFrame(size_t frame_index) {
-        if (frame_index >= frames.size()) {
-            // index out of range
-            return AnimDataFrame();
-        }
-        return frames[frame_index];
+        return GetTrack()->GetFrame(frame_index);
     }
 
+    // Edits copy the track, since readers may hold the current one.
     size_t AnimationClient::AddFrame(AnimDataFrame &frame) {
-        frames.push_back(frame);
-        return frames.size();
+        size_t count = 0;
+        track.Edit([&](AnimationTrack &edited) {
+            edited.AddFrame(frame);
+            count = edited.GetFramesCount();
+            return true;
+        }, GetCurrentTime());
+        return count;
     }
 
     size_t AnimationClient::RemoveFrames(size_t first, size_t last) {
-        if (first > frames.size()) {
-            return 0;
-        }
-        size_t last_limit = std::min(frames.size(), last);
-        frames.erase(frames.begin() + first, frames.begin() + last_limit);
-        return last_limit - first;
+        size_t removed = 0;
+        track.Edit([&](AnimationTrack &edited) {
+            removed = edited.RemoveFrames(first, last);
+            return removed > 0;
+        }, GetCurrentTime());
+        return removed;
     }
 
     size_t AnimationClient::InsertFrame(size_t after, AnimDataFrame &frame) {
-        if (after > frames.size()) {
-            return -1;
-        }
-        frames.insert(frames.begin() + after, frame);
-        return frames.size();
+        size_t count = -1;
+        track.Edit([&](AnimationTrack &edited) {
+            if (!edited.InsertFrame(after, frame)) {
+                return false;
+            }
+            count = edited.GetFramesCount();
+            return true;
+        }, GetCurrentTime());
+        return count;
     }
 
     size_t AnimationClient::ReplaceFrame(size_t frame_index, AnimDataFrame &frame) {
-        if (frame_index >= frames.size()) {
-            return -1;
-        }
-        frames[frame_index] = frame;
-        return frames.size();
+        size_t count = -1;
+        track.Edit([&](AnimationTrack &edited) {
+            if (!edited.ReplaceFrame(frame_index, frame)) {
+                return false;
+            }
+            count = edited.GetFramesCount();
+            return true;
+        }, GetCurrentTime());
+        return count;
     }
 
     std::vector<float> AnimationClient::GetBlendshapeWeights(float seconds, Infinity postinfinity) {
-        float frame_number = seconds * framerate;
-        size_t right = std::ceil(frame_number);
-        size_t left = std::floor(frame_number);
+        auto current = GetTrack();
+        std::vector<float> result(sampleTrack(*current, seconds, false, nullptr, 0, postinfinity));
+        sampleTrack(*current, seconds, false, result.data(), result.size(), postinfinity);
+        return result;
+    }
+
+    std::vector<float> AnimationClient::GetBlendshapeWeights(size_t frame_index, Infinity postinfinity) {
+        auto current = GetTrack();
+        return current->GetBlendshapeWeights(getValidFrameIndex(*current, frame_index, postinfinity));
+    }
+
+    std::vector<float> AnimationClient::GetEmotionState(size_t frame_index, Infinity postinfinity) {
+        auto current = GetTrack();
+        return current->GetEmotionState(getValidFrameIndex(*current, frame_index, postinfinity));
+    }
+
+    ArrayView<const float> AnimationClient::GetBlendshapeWeightsView(size_t frame_index, Infinity postinfinity) {
+        auto current = GetTrack();
+        // an empty track gives an empty view
+        return current->GetBlendshapeView(getValidFrameIndex(*current, frame_index, postinfinity));
+    }
+
+    ArrayView<const float> AnimationClient::GetEmotionStateView(size_t frame_index, Infinity postinfinity) {
+        auto current = GetTrack();
+        return current->GetEmotionView(getValidFrameIndex(*current, frame_index, postinfinity));
+    }
 
-        std::vector<float> weights_r = GetBlendshapeWeights(right, postinfinity);
+    size_t AnimationClient::GetBlendshapeWeights(
+        float seconds, float *out, size_t capacity, Infinity postinfinity) {
+        return sampleTrack(*GetTrack(), seconds, false, out, capacity, postinfinity);
+    }
 
-        if (right == left) {
-            return weights_r;
+    size_t AnimationClient::GetEmotionState(
+        float seconds, float *out, size_t capacity, Infinity postinfinity) {
+        return sampleTrack(*GetTrack(), seconds, true, out, capacity, postinfinity);
+    }
+
+    size_t AnimationClient::sampleTrack(
+        AnimationTrack const &current, float seconds, bool emotions, float *out, size_t capacity,
+        Infinity postinfinity) {
+        double frame_number = getFramePosition(current, seconds);
+        size_t right = getValidFrameIndex(current, std::ceil(frame_number), postinfinity);
+        size_t left = getValidFrameIndex(current, std::floor(frame_number), postinfinity);
+        float t = frame_number - std::floor(frame_number);
+        if (emotions) {
+            return sampleRows(current.GetEmotionView(left), current.GetEmotionView(right), t, out, capacity);
         }
-        // else
-        float w1 = frame_number - left;
-        std::vector<float> weights_l = GetBlendshapeWeights(left, postinfinity);
+        return sampleRows(current.GetBlendshapeView(left), current.GetBlendshapeView(right), t, out, capacity);
+    }
 
-        std::vector<float> result;
-        for (int i=0; i < weights_r.size(); i++) {
-            result.push_back(weights_r[i] * w1 + weights_l[i] * (1.0 - w1));
+    AceClientStatus AnimationClient::SampleRange(
+        float t0, float t1, float fps, Infinity postinfinity, SampledRange *out, size_t maxThreads) {
+        if (out == nullptr || !(fps > 0.0f) || !(t1 >= t0)) {
+            return AceClientStatus::ERROR_INVALID_INPUT;
         }
-        return result;
+        // every thread samples the same version of the animation
+        auto current = GetTrack();
+        out->frames = static_cast<size_t>(std::floor((t1 - t0) * fps + 1e-4)) + 1;
+        out->channels = current->GetBlendshapeCount();
+        out->values.assign(out->frames * out->channels, 0.0f);
+        if (out->channels == 0 || current->GetFramesCount() < 1) {
+            return AceClientStatus::OK;
+        }
+
+        size_t blockCount = (out->frames + SAMPLE_RANGE_BLOCK_SIZE - 1) / SAMPLE_RANGE_BLOCK_SIZE;
+        std::atomic<size_t> nextBlock(0);
+        auto worker = [&]() {
+            for (size_t block = nextBlock++; block < blockCount; block = nextBlock++) {
+                size_t end = std::min(out->frames, (block + 1) * SAMPLE_RANGE_BLOCK_SIZE);
+                for (size_t i = block * SAMPLE_RANGE_BLOCK_SIZE; i < end; ++i) {
+                    float seconds = static_cast<float>(t0 + i / static_cast<double>(fps));
+                    sampleTrack(*current, seconds, false, out->values.data() + i * out->channels, out->channels,
+                        postinfinity);
+                }
+            }
+        };
+
+        size_t threadCount = std::min(std::max<size_t>(maxThreads, 1), blockCount);
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        return AceClientStatus::OK;
     }
 
-    std::vector<float> AnimationClient::GetBlendshapeWeights(size_t frame_index, Infinity postinfinity) {
-        size_t valid_frame_idx = getValidFrameIndex(frame_index, postinfinity);
-        if (valid_frame_idx < 0) {
-            return {};
+    size_t AnimationClient::GetBlendshapeWeights(
+        size_t frame_index, float *out, size_t capacity, Infinity postinfinity) {
+        ArrayView<const float> weights = GetBlendshapeWeightsView(frame_index, postinfinity);
+        if (weights.size() <= capacity) {
+            std::copy(weights.begin(), weights.end(), out);
         }
-        AnimDataFrame frame = GetFrame(valid_frame_idx);
-        return frame.blend_shape_weights;
+        return weights.size();
     }
 
-    std::vector<float> AnimationClient::GetEmotionState(size_t frame_index, Infinity postinfinity) {
-        size_t valid_frame_idx = getValidFrameIndex(frame_index, postinfinity);
-        if (valid_frame_idx < 0) {
-            return {};
+    size_t AnimationClient::GetEmotionState(
+        size_t frame_index, float *out, size_t capacity, Infinity postinfinity) {
+        ArrayView<const float> emotions = GetEmotionStateView(frame_index, postinfinity);
+        if (emotions.size() <= capacity) {
+            std::copy(emotions.begin(), emotions.end(), out);
         }
-        AnimDataFrame frame = GetFrame(valid_frame_idx);
-        return frame.emotion_state;
+        return emotions.size();
     }
 
     size_t AnimationClient::getValidFrameIndex(size_t frame_index, Infinity postinfinity) {
-        size_t frame_count = GetFramesCount();
+        return getValidFrameIndex(*GetTrack(), frame_index, postinfinity);
+    }
+
+    size_t AnimationClient::getValidFrameIndex(AnimationTrack const &current, size_t frame_index, Infinity postinfinity) {
+        size_t frame_count = current.GetFramesCount();
+        if (frame_count == 0) {
+            // out of range either way
+            return frame_index;
+        }
         // adjust frame index
         if (postinfinity == Constant) {
             frame_index = std::min(frame_index, frame_count - 1);
         }
         else if (postinfinity == Cycle) {
-            while (frame_index >= frame_count) {
-                frame_index -= frame_count;
-            }
-        }
-        else if (frame_index > frame_count) {
-            return -1;
+            frame_index %= frame_count;
         }
         return frame_index;
     }
 
     std::vector<std::string> AnimationClient::GetBlendshapeNames() {
-        if (GetFramesCount() < 1) {
+        auto current = GetTrack();
+        if (current->GetFramesCount() < 1) {
             return {};
         }
-        AnimDataFrame frame = GetFrame(0);
-        return frame.blend_shape_names;
+        return current->GetBlendshapeNames();
     }
 
     std::vector<std::string> AnimationClient::GetEmotionStateNames() {
-        if (GetFramesCount() < 1) {
+        auto current = GetTrack();
+        if (current->GetFramesCount() < 1) {
+            return {};
+        }
+        return current->GetEmotionStateNames();
+    }
+
+    ArrayView<const std::string> AnimationClient::GetBlendshapeNamesView() {
+        auto current = GetTrack();
+        if (current->GetFramesCount() < 1) {
             return {};
         }
-        AnimDataFrame frame = GetFrame(0);
-        return frame.emotion_state_names;
+        return current->GetBlendshapeNames();
+    }
+
+    ArrayView<const std::string> AnimationClient::GetEmotionStateNamesView() {
+        auto current = GetTrack();
+        if (current->GetFramesCount() < 1) {
+            return {};
+        }
+        return current->GetEmotionStateNames();
     }
 
     long long AnimationClient::GetLastUpdated() {
-        return lastUpdated;
+        return track.GetPublishedTime();
+    }
+
+    std::shared_ptr<const AnimationTrack> AnimationClient::GetTrack() {
+        return track.Get();
     }
 
     AceClientStatus AnimationClient::UpdateAnimation(std::vector<int16_t> const &samples) {
-        // TODO: thread lock and release
-        frames.clear();
-        AceClientStatus result = RequestAnimation(samples, &frames);
+        MemoryAudioSource audio(samples.data(), samples.size());
+        return UpdateAnimation(audio);
+    }
+
+    AceClientStatus AnimationClient::UpdateAnimation(AudioSource const &audio) {
+        RequestKey key;
+        if (useClipCache) {
+            key = GetRequestKey(audio);
+            std::shared_ptr<const AnimationTrack> cached = ClipCache::Instance().Get(key);
+            if (cached) {
+                track.Publish(cached, GetCurrentTime());
+                return AceClientStatus::OK;
+            }
+        }
+
+        // received off to the side; readers see the previous animation until it is complete
+        auto received = std::make_shared<AnimationTrack>();
+        // one row per frame of the audio
+        received->Reserve(audio.GetSampleCount() * framerate / DefaultSampleRate + 1);
+        AceClientStatus result = RequestAnimation(audio, received.get());
         if (result != AceClientStatus::OK) {
             LOG_ERROR("Error while updating animation: " << result);
             return result;
         }
+        if (useClipCache) {
+            ClipCache::Instance().Put(key, received);
+        }
 
-        // set updated tick to check last-updated
-        lastUpdated = GetCurrentTime();
-
+        track.Publish(received, GetCurrentTime());
         return result;
     }
 
     AceClientStatus AnimationClient::RequestAnimation(
         std::vector<int16_t> const &samples,
         std::vector<AnimDataFrame> *frames
+    ) {
+        FrameCollector collector(frames);
+        return RequestAnimation(samples, &collector);
+    }
+
+    AceClientStatus AnimationClient::RequestAnimation(
+        std::vector<int16_t> const &samples,
+        FrameReceiver *receiver
+    ) {
+        MemoryAudioSource audio(samples.data(), samples.size());
+        return RequestAnimation(audio, receiver);
+    }
+
+    AceClientStatus AnimationClient::RequestAnimation(
+        AudioSource const &audio,
+        FrameReceiver *receiver
     ) {
         /*This is a blocking ace animation communicator.*/
+        lastRequestStats = RequestStats();
+        if (audio.GetSampleRate() != DefaultSampleRate) {
+            LOG_ERROR("Audio at " << audio.GetSampleRate() << "Hz; it must be resampled to " << DefaultSampleRate << "Hz");
+            receiver->OnComplete(AceClientStatus::ERROR_INVALID_INPUT);
+            return AceClientStatus::ERROR_INVALID_INPUT;
+        }
+
+        RequestKey key;
+        if (diskCache || coalesceRequests) {
+            key = GetRequestKey(audio);
+        }
+        if (diskCache) {
+            AnimationTrack cached;
+            if (diskCache->Load(key, &cached)) {
+                LOG_INFO("Loaded the animation from " << diskCache->GetPath(key));
+                cached.Emit(receiver);
+                receiver->OnComplete(AceClientStatus::OK);
+                return AceClientStatus::OK;
+            }
+        }
 
-        // establish connection to a2f controller using grpc client
+        // Identical requests to the same endpoint share one stream; the waiters get the result
+        // of the first one, whether it succeeded or not.
+        RequestKey flightKey = key;
+        std::optional<CoalescedCompletion> completion;
+        if (coalesceRequests) {
+            // the key already covers the endpoint; requests with different credentials may fail
+            // differently, so they are not shared
+            std::string const apiKey = GetAPIKey();
+            flightKey.parameters = Hash64(apiKey.data(), apiKey.size(), key.parameters);
+            std::shared_future<CoalescedResult> inFlight;
+            if (!RequestCoalescer::Instance().Join(flightKey, &inFlight)) {
+                LOG_INFO("Waiting for an identical request in flight");
+                CoalescedResult const &result = inFlight.get();
+                if (result.track) {
+                    result.track->Emit(receiver);
+                }
+                receiver->OnComplete(result.status);
+                return result.status;
+            }
+            completion.emplace(flightKey);
+        }
+
+        // keep a copy of the frames for the caches and the waiters while they are delivered
+        auto received = std::make_shared<AnimationTrack>();
+        FrameTee tee(received.get(), receiver);
+
+        // When the stream breaks after frames have arrived, only the remaining audio and some
+        // preceding context are sent again, and the new frames are spliced onto the received ones.
+        FrameSplicer splicer((diskCache || coalesceRequests) ? &tee : receiver);
+        size_t firstSample = 0;
+        long long backoff = retryPolicy.initialBackoffMs;
+        AceClientStatus status;
+        for (int attempt = 0; ; ++attempt) {
+            splicer.SetTimeOffset(static_cast<double>(firstSample) / DefaultSampleRate);
+            AudioSourceRange remaining(audio, firstSample, audio.GetSampleCount() - firstSample);
+            status = requestAnimation(remaining, &splicer);
+            // a server that never produced a frame is not retried, so a bad setup fails fast
+            if (status == AceClientStatus::OK || !isRetryable(status) ||
+                !splicer.HasFrames() || attempt >= retryPolicy.maxRetries) {
+                break;
+            }
+
+            double resumeTime = splicer.GetResumeTime(retryPolicy.prerollSeconds);
+            firstSample = std::min(audio.GetSampleCount(), static_cast<size_t>(std::llround(resumeTime * DefaultSampleRate)));
+            LOG_INFO("Request failed: " << status << ". Resuming from " << resumeTime << "s in " << backoff << "ms.");
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff));
+            backoff = std::min(static_cast<long long>(backoff * retryPolicy.backoffMultiplier), retryPolicy.maxBackoffMs);
+        }
+        if (diskCache && status == AceClientStatus::OK) {
+            diskCache->Store(key, *received);
+        }
+        if (completion) {
+            CoalescedResult result;
+            result.status = status;
+            if (status == AceClientStatus::OK) {
+                result.track = received;
+            }
+            completion->Complete(result);
+        }
+        receiver->OnComplete(status);
+        return status;
+    }
+
+    AceClientStatus AnimationClient::requestAnimation(
+        AudioSource const &audio,
+        FrameReceiver *receiver
+    ) {
+        // reuse the pooled connection to a2f controller, or establish a new one
         std::string address = GetNetworkAddress();
-        std::shared_ptr<grpc::Channel> channel = CreateChannel(address);
+        bool secured = isConnectionSecured();
+        std::shared_ptr<const PooledConnection> connection = ChannelPool::Instance().Acquire(address, secured);
 
         std::string apiKey = GetAPIKey();
         std::string functionId = GetFunctionId();
-        AceClientStatus status = A2FControllerHealthCheck(channel, apiKey, functionId);
+        AceClientStatus status = checkHealth(connection);
         if (status != AceClientStatus::OK) {
+            if (isConnectionError(status)) {
+                ChannelPool::Instance().Invalidate(address, secured);
+            }
             return status;
         }
-        LOG_DEBUG("Connection secured(using https): " << isConnectionSecured());
+        LOG_DEBUG("Connection secured(using https): " << secured);
 
         std::unique_ptr<A2FControllerClient> a2f_client(
-            new A2FControllerClient(channel, apiKey, functionId));
+            new A2FControllerClient(connection->a2fStub, apiKey, functionId));
 
         // set parameters
         FetchClientParameters(*a2f_client);
 
         // send audio samples to a2f controller and retreive blendshape frames etc
-        LOG_INFO("Sending " << samples.size() << " audio samples.");
-        return a2f_client->ProcessAudioStream(
-            samples.data(), samples.size(), emotionState, frames);
+        LOG_INFO("Sending " << audio.GetSampleCount() << " audio samples.");
+        status = a2f_client->ProcessAudioStream(audio, emotionState, receiver);
+        RequestStats const &stats = a2f_client->GetLastRequestStats();
+        lastRequestStats.chunk_sizes.insert(lastRequestStats.chunk_sizes.end(), stats.chunk_sizes.begin(), stats.chunk_sizes.end());
+        lastRequestStats.bytes_sent += stats.bytes_sent;
+        lastRequestStats.compressed_bytes_sent += stats.compressed_bytes_sent;
+        lastRequestStats.sampled_bytes_sent += stats.sampled_bytes_sent;
+        lastRequestStats.sampled_messages += stats.sampled_messages;
+        lastRequestStats.bytes_received += stats.bytes_received;
+        if (status != AceClientStatus::OK) {
+            // check again next time instead of trusting a stale result
+            HealthCache::Instance().Invalidate(address, secured, apiKey, functionId);
+        }
+        if (isConnectionError(status)) {
+            ChannelPool::Instance().Invalidate(address, secured);
+        }
+        return status;
     }
 
-    std::shared_ptr<grpc::Channel> AnimationClient::CreateChannel(std::string address) {
-        // establish connection to a2f controller using grpc client
-        std::shared_ptr<grpc::Channel> channel;
-        if (isConnectionSecured()) {
-            grpc::SslCredentialsOptions ssl_opts;
-            auto creds = grpc::SslCredentials(ssl_opts);
-            channel = grpc::CreateChannel(address, creds);
+    AceClientStatus AnimationClient::checkHealth(std::shared_ptr<const PooledConnection> connection) {
+        if (healthCheckMode == HealthCheckSkip) {
+            return AceClientStatus::OK;
         }
-        else {
-            channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+        std::string address = GetNetworkAddress();
+        bool secured = isConnectionSecured();
+        std::string apiKey = GetAPIKey();
+        std::string functionId = GetFunctionId();
+        if (healthCheckMode == HealthCheckCached &&
+            HealthCache::Instance().IsHealthy(address, secured, apiKey, functionId, healthCheckTTL)) {
+            return AceClientStatus::OK;
         }
-        return channel;
+        AceClientStatus status = A2FControllerHealthCheck(connection->healthStub, apiKey, functionId);
+        if (status == AceClientStatus::OK) {
+            HealthCache::Instance().MarkHealthy(address, secured, apiKey, functionId);
+        } else {
+            HealthCache::Instance().Invalidate(address, secured, apiKey, functionId);
+        }
+        return status;
+    }
+
+    AceClientStatus AnimationClient::SetChunkingOptions(ChunkingOptions const &options) {
+        if (!IsValidChunkingOptions(options)) {
+            return AceClientStatus::ERROR_INVALID_INPUT;
+        }
+        chunkingOptions = options;
+        return AceClientStatus::OK;
+    }
+
+    ChunkingOptions const AnimationClient::GetChunkingOptions() {
+        return chunkingOptions;
+    }
+
+    void AnimationClient::SetCompression(CompressionMode mode) {
+        compression = mode;
+    }
+
+    CompressionMode AnimationClient::GetCompression() {
+        return compression;
+    }
+
+    void AnimationClient::SetCompressionEstimate(size_t messages) {
+        compressionEstimate = messages;
+    }
+
+    size_t AnimationClient::GetCompressionEstimate() {
+        return compressionEstimate;
+    }
+
+    RequestStats const AnimationClient::GetLastRequestStats() {
+        return lastRequestStats;
+    }
+
+    void AnimationClient::SetRetryPolicy(RetryPolicy const &policy) {
+        retryPolicy = policy;
+    }
+
+    RetryPolicy const AnimationClient::GetRetryPolicy() {
+        return retryPolicy;
+    }
+
+    void AnimationClient::SetHealthCheckMode(HealthCheckMode mode) {
+        healthCheckMode = mode;
+    }
+
+    HealthCheckMode AnimationClient::GetHealthCheckMode() {
+        return healthCheckMode;
+    }
+
+    void AnimationClient::SetHealthCheckTTL(long long milliseconds) {
+        healthCheckTTL = milliseconds;
+    }
+
+    long long AnimationClient::GetHealthCheckTTL() {
+        return healthCheckTTL;
+    }
+
+    void AnimationClient::SetUseClipCache(bool use) {
+        useClipCache = use;
+    }
+
+    bool AnimationClient::GetUseClipCache() {
+        return useClipCache;
+    }
+
+    void AnimationClient::SetCoalesceRequests(bool coalesce) {
+        coalesceRequests = coalesce;
+    }
+
+    bool AnimationClient::GetCoalesceRequests() {
+        return coalesceRequests;
+    }
+
+    void AnimationClient::SetDiskCache(std::shared_ptr<DiskCache> cache) {
+        diskCache = cache;
+    }
+
+    std::shared_ptr<DiskCache> AnimationClient::GetDiskCache() {
+        return diskCache;
+    }
+
+    RequestKey AnimationClient::GetRequestKey(const int16_t *samples, size_t sample_count) {
+        MemoryAudioSource audio(samples, sample_count);
+        return GetRequestKey(audio);
+    }
+
+    RequestKey AnimationClient::GetRequestKey(AudioSource const &audio) {
+        // the parameters exactly as they are sent in the AudioStreamHeader
+        A2FControllerClient a2f_client(
+            std::shared_ptr<A2FControllerService::StubInterface>(), GetAPIKey(), GetFunctionId());
+        FetchClientParameters(a2f_client);
+        std::string parameters = std::to_string(requestKeyVersion);
+        parameters.push_back('\0');
+        parameters += a2f_client.GetSerializedParameters();
+        parameters.push_back('\0');
+        parameters += GetFunctionId();
+        // other deployments may serve another model under the same function id; the API key is
+        // left out so that keys can be rotated without losing the cache
+        parameters.push_back('\0');
+        parameters += GetNetworkAddress();
+        // the emotion state is sent with the audio rather than in the header
+        float const emotions[] = {
+            emotionState.amazement, emotionState.anger, emotionState.cheekiness, emotionState.disgust,
+            emotionState.fear, emotionState.grief, emotionState.joy, emotionState.out_of_breath,
+            emotionState.pain, emotionState.sadness,
+        };
+        parameters.append(reinterpret_cast<const char *>(emotions), sizeof(emotions));
+
+        RequestKey key;
+        key.audio = audio.GetContentHash();
+        key.parameters = Hash64(parameters.data(), parameters.size());
+        return key;
     }
 
     void AnimationClient::FetchClientParameters(A2FControllerClient &a2f_client) {
@@ -273,6 +722,11 @@ namespace mace {
         for (auto entry: blendshapeOffsets) {
             a2f_client.SetBlendshapeOffset(entry.first.c_str(), entry.second);
         }
+
+        /// upload
+        a2f_client.SetChunkingOptions(chunkingOptions);
+        a2f_client.SetCompression(compression);
+        a2f_client.SetCompressionEstimate(compressionEstimate);
     }
 
     bool AnimationClient::SetFaceParameters(AceFaceParameters const &new_parameters) {
@@ -419,6 +873,7 @@ namespace mace {
     AceClientStatus AnimationClient::SetUrl(std::string const &newUrl) {
         if ((newUrl.length() >= 7 && newUrl.substr(0, 7) == "http://") ||
             (newUrl.length() >= 8 && newUrl.substr(0, 8) == "https://")) {
+            // the pooled channel of the previous url may still be used by other clients; it expires when idle
             _url = newUrl;
             return AceClientStatus::OK;
         }
@@ -446,6 +901,7 @@ namespace mace {
     }
 
     AceClientStatus AnimationClient::SetAPIKey(std::string const &newApiKey) {
+        // the key is sent with each call, so the shared channel stays
         _apiKey = newApiKey;
         return AceClientStatus::OK;
     }
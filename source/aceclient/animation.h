@@ -21,21 +21,33 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <system_error>
 #include <vector>
 
 #include "a2f_controller_client.h"
 #include "aceclient.h"
+#include "animation_track.h"
+#include "array_view.h"
+#include "audio_source.h"
+#include "channel_pool.h"
+#include "clip_cache.h"
+#include "disk_cache.h"
 
 #include "frame_receiver.h"
+#include "hash.h"
+#include "health_cache.h"
 #include "parameters.h"
+#include "request_coalescer.h"
 
 #define KEY_VALUE std::pair<std::string, float>
 
 namespace mace {
 
 const uint16_t DEFAULT_FRAMERATE = 30;
+// Fraction of a frame a time may be past a frame timestamp and still find that frame.
+const double FRAME_POSITION_TOLERANCE = 0.01;
 
 enum Infinity {
     Constant, Cycle,
@@ -43,10 +55,32 @@ enum Infinity {
 
 long long GetCurrentTime();
 
+// How a request is resumed when its stream breaks.
+struct RetryPolicy {
+    // 0 disables resuming
+    int maxRetries = 3;
+    long long initialBackoffMs = 250;
+    double backoffMultiplier = 2.0;
+    long long maxBackoffMs = 4000;
+    // audio sent again before the last received frame, as context for the inference
+    double prerollSeconds = 0.5;
+};
+
+// Frames of blendshape weights sampled at a regular rate, as a dense row-major matrix of
+// frames x channels.
+struct SampledRange {
+    size_t frames = 0;
+    size_t channels = 0;
+    std::vector<float> values;
+};
+
+// Frames sampled by one thread of SampleRange
+const size_t SAMPLE_RANGE_BLOCK_SIZE = 512;
+
 class AnimationClient {
 public:
     AnimationClient();
-    ~AnimationClient();
+    virtual ~AnimationClient();
 
     // Main Param Setters
     bool SetFaceParameters(AceFaceParameters const &new_parameters);
@@ -79,20 +113,55 @@ public:
         std::vector<int16_t> const &samples,
         std::vector<AnimDataFrame> *frames
     );
+    // Delivers frames to the receiver while the response is still streaming; OnComplete() is
+    // always called once, including when the health check fails.
+    AceClientStatus RequestAnimation(
+        std::vector<int16_t> const &samples,
+        FrameReceiver *receiver
+    );
+    // Reads the audio block by block while it is uploaded; it must be at DefaultSampleRate.
+    AceClientStatus RequestAnimation(
+        AudioSource const &audio,
+        FrameReceiver *receiver
+    );
     AceClientStatus UpdateAnimation(
         std::vector<int16_t> const &samples
     );
+    AceClientStatus UpdateAnimation(
+        AudioSource const &audio
+    );
     long long GetLastUpdated();
     void FetchClientParameters(A2FControllerClient &client);
 
     // Access to the animation frames
     // TODO: consider splitting these to a separate class
+    // Readers are lock-free (see PublishedTrack): updates and edits build a new track and publish
+    // it in one pointer swap, so each call sees one complete version of the animation.
+    // The current animation; holding it keeps this version alive and unchanged across updates.
+    std::shared_ptr<const AnimationTrack> GetTrack();
     std::vector<float> GetBlendshapeWeights(float seconds, Infinity postinfinity=Constant);
     std::vector<float> GetBlendshapeWeights(size_t frame_index, Infinity postinfinity=Constant);
     std::vector<std::string> GetBlendshapeNames();
     std::vector<float> GetEmotionState(size_t frame_index, Infinity postinfinity=Constant);
     std::vector<std::string> GetEmotionStateNames();
 
+    // Views into the received animation, without copying. A view is valid until the animation
+    // is updated or edited; hold GetTrack() to read it across updates of another thread.
+    ArrayView<const float> GetBlendshapeWeightsView(size_t frame_index, Infinity postinfinity=Constant);
+    ArrayView<const float> GetEmotionStateView(size_t frame_index, Infinity postinfinity=Constant);
+    ArrayView<const std::string> GetBlendshapeNamesView();
+    ArrayView<const std::string> GetEmotionStateNamesView();
+    // Write the values into a buffer of the caller and return the number of values of the frame.
+    // Nothing is written when the capacity is smaller than that number.
+    size_t GetBlendshapeWeights(float seconds, float *out, size_t capacity, Infinity postinfinity=Constant);
+    size_t GetBlendshapeWeights(size_t frame_index, float *out, size_t capacity, Infinity postinfinity=Constant);
+    size_t GetEmotionState(float seconds, float *out, size_t capacity, Infinity postinfinity=Constant);
+    size_t GetEmotionState(size_t frame_index, float *out, size_t capacity, Infinity postinfinity=Constant);
+    // Sample the blendshape weights from t0 to t1, both included, at fps frames per second.
+    // Blocks of frames are sampled on up to maxThreads threads. A frame without weights is zero.
+    AceClientStatus SampleRange(
+        float t0, float t1, float fps, Infinity postinfinity, SampledRange *out, size_t maxThreads=1);
+
     bool HasAnimation(float seconds=0.0f);
     bool HasAnimation(size_t frame_index=0);
 
@@ -114,6 +183,43 @@ public:
 
     bool IsClientCreated();
 
+    AceClientStatus SetChunkingOptions(ChunkingOptions const &options);
+    ChunkingOptions const GetChunkingOptions();
+    void SetCompression(CompressionMode mode);
+    CompressionMode GetCompression();
+    // See A2FControllerClient::SetCompressionEstimate; off by default.
+    void SetCompressionEstimate(size_t messages);
+    size_t GetCompressionEstimate();
+    // Stats of the last RequestAnimation, including every resumed attempt
+    RequestStats const GetLastRequestStats();
+
+    void SetRetryPolicy(RetryPolicy const &policy);
+    RetryPolicy const GetRetryPolicy();
+
+    // Pre-flight health check before each request
+    void SetHealthCheckMode(HealthCheckMode mode);
+    HealthCheckMode GetHealthCheckMode();
+    void SetHealthCheckTTL(long long milliseconds);
+    long long GetHealthCheckTTL();
+
+    // Share the animation of UpdateAnimation with other clients of the process through
+    // ClipCache, and reuse theirs for the same audio and parameters without a request.
+    void SetUseClipCache(bool use);
+    bool GetUseClipCache();
+    // Let identical requests of the process made while one is in flight wait for its result
+    // instead of going to the server. Off by default: every request then hashes its audio and
+    // keeps a copy of the received frames for the waiters.
+    void SetCoalesceRequests(bool coalesce);
+    bool GetCoalesceRequests();
+    // Reuse the animation of earlier requests with the same audio and parameters from a cache
+    // directory, which may be shared with other clients and processes; nullptr disables it.
+    void SetDiskCache(std::shared_ptr<DiskCache> cache);
+    std::shared_ptr<DiskCache> GetDiskCache();
+    // The key of a request of the audio with the current parameters and endpoint; the API key
+    // is not part of it. A resampled source is keyed by its source and rate (see GetContentHash).
+    RequestKey GetRequestKey(const int16_t *samples, size_t sample_count);
+    RequestKey GetRequestKey(AudioSource const &audio);
+
     // Destroy
     void Destroy();
 
@@ -126,9 +232,21 @@ protected:
     // vary for different models and configs. obtained from https://build.nvidia.com/nvidia/audio2face/api
     std::string _functionId = "462f7853-60e8-474a-9728-7b598e58472c";
     uint16_t framerate = DEFAULT_FRAMERATE;
-    long long lastUpdated = 0l;
+    HealthCheckMode healthCheckMode = HealthCheckCached;
+    long long healthCheckTTL = DEFAULT_HEALTH_CHECK_TTL_MS;
+    RetryPolicy retryPolicy;
+    ChunkingOptions chunkingOptions;
+    CompressionMode compression = CompressionNone;
+    size_t compressionEstimate = 0;
+    RequestStats lastRequestStats;
+    std::shared_ptr<DiskCache> diskCache;
+    bool coalesceRequests = false;
+    // hashed into the request keys; REQUEST_KEY_VERSION unless a test stands in for another build
+    uint32_t requestKeyVersion = REQUEST_KEY_VERSION;
 
-    std::vector<AnimDataFrame> frames;
+    // Shared with the clip cache and other clients once published; also holds the update time.
+    PublishedTrack track;
+    bool useClipCache = false;
 
     AceFaceParameters faceParameters;
     AceEmotionState emotionState;
@@ -139,8 +257,20 @@ protected:
 
     int findKeyIndex(std::string const &key, std::vector<KEY_VALUE> const &vec);
     size_t getValidFrameIndex(size_t frame_index, Infinity postinfinity);
+    size_t getValidFrameIndex(AnimationTrack const &current, size_t frame_index, Infinity postinfinity);
+    size_t getFrameIndex(AnimationTrack const &current, float seconds);
+    // The fractional frame index of a time, from the frame timestamps when the track has them.
+    double getFramePosition(AnimationTrack const &current, float seconds);
+    // Interpolate the blendshape weights, or the emotions, of a track at a time into out.
+    size_t sampleTrack(AnimationTrack const &current, float seconds, bool emotions, float *out, size_t capacity,
+        Infinity postinfinity);
     std::string const GetNetworkAddress();
     bool isConnectionSecured();
-    std::shared_ptr<grpc::Channel> CreateChannel(std::string address);
+    AceClientStatus checkHealth(std::shared_ptr<const PooledConnection> connection);
+    // A single attempt of RequestAnimation; does not complete the receiver.
+    virtual AceClientStatus requestAnimation(
+        AudioSource const &audio,
+        FrameReceiver *receiver
+    );
 };
 } // namespace mace
@@ -0,0 +1,574 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "animation_track.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mace {
+
+namespace {
+
+// Re-lays out a row-major matrix with a new row width, padding with zeros.
+void widenRows(std::vector<float> &values, size_t rows, size_t width, size_t new_width) {
+    std::vector<float> widened(rows * new_width, 0.0f);
+    for (size_t row = 0; row < rows; ++row) {
+        std::copy_n(values.begin() + row * width, width, widened.begin() + row * new_width);
+    }
+    values.swap(widened);
+}
+
+template <typename T>
+size_t capacityBytes(std::vector<T> const &values) {
+    return values.capacity() * sizeof(T);
+}
+
+const char CLIP_MAGIC[8] = {'M', 'A', 'C', 'E', 'C', 'L', 'I', 'P'};
+const uint32_t CLIP_VERSION = 1;
+const size_t EMIT_BATCH_SIZE = 256;
+
+struct ClipHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t frame_count;
+    uint64_t blendshape_count;
+    uint64_t emotion_count;
+    uint64_t blendshape_name_count;
+    uint64_t emotion_name_count;
+};
+
+void writeNames(std::ostream &out, std::vector<std::string> const &names) {
+    for (auto const &name : names) {
+        uint32_t length = static_cast<uint32_t>(name.size());
+        out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+        out.write(name.data(), name.size());
+    }
+}
+
+template <typename T>
+void writeColumn(std::ostream &out, std::vector<T> const &values) {
+    out.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+}
+
+// Reads sequentially from a clip, failing once it would read past the end.
+class ClipReader {
+public:
+    ClipReader(const char *data, size_t size) : m_data(data), m_size(size) {}
+
+    bool Read(void *out, size_t size) {
+        if (size > m_size - m_offset) {
+            return false;
+        }
+        std::memcpy(out, m_data + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    bool ReadNames(size_t count, std::vector<std::string> *names) {
+        names->clear();
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t length;
+            if (!Read(&length, sizeof(length)) || length > m_size - m_offset) {
+                return false;
+            }
+            names->emplace_back(m_data + m_offset, length);
+            m_offset += length;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool ReadColumn(size_t count, std::vector<T> *values) {
+        if (count > (m_size - m_offset) / sizeof(T)) {
+            return false;
+        }
+        values->resize(count);
+        return Read(values->data(), count * sizeof(T));
+    }
+
+    bool AtEnd() const {
+        return m_offset == m_size;
+    }
+
+private:
+    const char *m_data;
+    size_t m_size;
+    size_t m_offset = 0;
+};
+
+}
+
+void AnimationTrack::Clear() {
+    m_blendshapeNames.clear();
+    m_emotionStateNames.clear();
+    m_blendshapeCount = 0;
+    m_emotionCount = 0;
+    m_reservedFrames = 0;
+    m_timestamps.clear();
+    m_blendshapeWeights.clear();
+    m_emotionStates.clear();
+    m_hasBlendshapeWeights.clear();
+    m_hasEmotionState.clear();
+    m_timeIndexed = false;
+    m_uniformSpacing = false;
+}
+
+void AnimationTrack::Reserve(size_t frame_count) {
+    // the matrices are reserved again once the width of the rows is known
+    m_reservedFrames = frame_count;
+    m_timestamps.reserve(frame_count);
+    m_blendshapeWeights.reserve(frame_count * m_blendshapeCount);
+    m_emotionStates.reserve(frame_count * m_emotionCount);
+    m_hasBlendshapeWeights.reserve(frame_count);
+    m_hasEmotionState.reserve(frame_count);
+}
+
+void AnimationTrack::SetBlendshapeNames(std::vector<std::string> const &names) {
+    m_blendshapeNames = names;
+}
+
+std::vector<std::string> const &AnimationTrack::GetBlendshapeNames() const {
+    return m_blendshapeNames;
+}
+
+void AnimationTrack::SetEmotionStateNames(std::vector<std::string> const &names) {
+    m_emotionStateNames = names;
+}
+
+std::vector<std::string> const &AnimationTrack::GetEmotionStateNames() const {
+    return m_emotionStateNames;
+}
+
+size_t AnimationTrack::GetFramesCount() const {
+    return m_timestamps.size();
+}
+
+size_t AnimationTrack::GetBlendshapeCount() const {
+    return m_blendshapeCount;
+}
+
+size_t AnimationTrack::GetEmotionCount() const {
+    return m_emotionCount;
+}
+
+double AnimationTrack::GetTimestamp(size_t frame_index) const {
+    if (frame_index >= m_timestamps.size()) {
+        return 0.0;
+    }
+    return m_timestamps[frame_index];
+}
+
+bool AnimationTrack::HasTimeIndex() const {
+    return m_timeIndexed;
+}
+
+bool AnimationTrack::HasUniformSpacing() const {
+    return m_timeIndexed && m_uniformSpacing;
+}
+
+double AnimationTrack::GetFrameInterval() const {
+    if (!m_timeIndexed) {
+        return 0.0;
+    }
+    return (m_timestamps.back() - m_timestamps.front()) / (m_timestamps.size() - 1);
+}
+
+double AnimationTrack::GetFramePosition(double seconds) const {
+    if (!m_timeIndexed) {
+        return 0.0;
+    }
+    size_t count = m_timestamps.size();
+    double first = m_timestamps.front();
+    double last = m_timestamps.back();
+    double interval = GetFrameInterval();
+    if (seconds <= first) {
+        return (seconds - first) / interval;
+    }
+    if (seconds >= last) {
+        return (count - 1) + (seconds - last) / interval;
+    }
+
+    // find the frame i with m_timestamps[i] <= seconds < m_timestamps[i + 1]
+    size_t i = 0;
+    if (m_uniformSpacing) {
+        // the even spacing points at the frame, up to the jitter of the timestamps
+        i = std::min(static_cast<size_t>((seconds - first) / interval), count - 2);
+        while (i > 0 && m_timestamps[i] > seconds) {
+            --i;
+        }
+        while (i + 2 < count && m_timestamps[i + 1] <= seconds) {
+            ++i;
+        }
+    }
+    else {
+        i = std::upper_bound(m_timestamps.begin(), m_timestamps.end(), seconds) - m_timestamps.begin() - 1;
+    }
+    return i + (seconds - m_timestamps[i]) / (m_timestamps[i + 1] - m_timestamps[i]);
+}
+
+bool AnimationTrack::HasBlendshapeWeights(size_t frame_index) const {
+    return frame_index < m_hasBlendshapeWeights.size() && m_hasBlendshapeWeights[frame_index];
+}
+
+bool AnimationTrack::HasEmotionState(size_t frame_index) const {
+    return frame_index < m_hasEmotionState.size() && m_hasEmotionState[frame_index];
+}
+
+const float *AnimationTrack::GetBlendshapeRow(size_t frame_index) const {
+    if (!HasBlendshapeWeights(frame_index)) {
+        return nullptr;
+    }
+    return m_blendshapeWeights.data() + frame_index * m_blendshapeCount;
+}
+
+const float *AnimationTrack::GetEmotionRow(size_t frame_index) const {
+    if (!HasEmotionState(frame_index)) {
+        return nullptr;
+    }
+    return m_emotionStates.data() + frame_index * m_emotionCount;
+}
+
+ArrayView<const float> AnimationTrack::GetBlendshapeView(size_t frame_index) const {
+    return ArrayView<const float>(GetBlendshapeRow(frame_index), m_blendshapeCount);
+}
+
+ArrayView<const float> AnimationTrack::GetEmotionView(size_t frame_index) const {
+    return ArrayView<const float>(GetEmotionRow(frame_index), m_emotionCount);
+}
+
+std::vector<float> AnimationTrack::GetBlendshapeWeights(size_t frame_index) const {
+    return GetBlendshapeView(frame_index).ToVector();
+}
+
+std::vector<float> AnimationTrack::GetEmotionState(size_t frame_index) const {
+    return GetEmotionView(frame_index).ToVector();
+}
+
+AnimDataFrame AnimationTrack::GetFrame(size_t frame_index) const {
+    AnimDataFrame frame;
+    if (frame_index >= GetFramesCount()) {
+        // index out of range
+        return frame;
+    }
+    frame.blend_shape_names = m_blendshapeNames;
+    frame.emotion_state_names = m_emotionStateNames;
+    frame.blend_shape_weights = GetBlendshapeWeights(frame_index);
+    frame.emotion_state = GetEmotionState(frame_index);
+    frame.timestamp = m_timestamps[frame_index];
+    return frame;
+}
+
+void AnimationTrack::AddFrame(AnimDataFrame const &frame) {
+    InsertFrame(GetFramesCount(), frame);
+}
+
+bool AnimationTrack::InsertFrame(size_t frame_index, AnimDataFrame const &frame) {
+    if (frame_index > GetFramesCount()) {
+        return false;
+    }
+    widen(frame.blend_shape_weights.size(), frame.emotion_state.size());
+    m_timestamps.insert(m_timestamps.begin() + frame_index, 0.0);
+    m_blendshapeWeights.insert(m_blendshapeWeights.begin() + frame_index * m_blendshapeCount, m_blendshapeCount, 0.0f);
+    m_emotionStates.insert(m_emotionStates.begin() + frame_index * m_emotionCount, m_emotionCount, 0.0f);
+    m_hasBlendshapeWeights.insert(m_hasBlendshapeWeights.begin() + frame_index, 0);
+    m_hasEmotionState.insert(m_hasEmotionState.begin() + frame_index, 0);
+    setRow(frame_index, frame);
+    if (frame_index + 1 == GetFramesCount()) {
+        indexFrame(GetFramesCount());
+    }
+    else {
+        rebuildTimeIndex();
+    }
+    return true;
+}
+
+bool AnimationTrack::ReplaceFrame(size_t frame_index, AnimDataFrame const &frame) {
+    if (frame_index >= GetFramesCount()) {
+        return false;
+    }
+    widen(frame.blend_shape_weights.size(), frame.emotion_state.size());
+    setRow(frame_index, frame);
+    rebuildTimeIndex();
+    return true;
+}
+
+size_t AnimationTrack::RemoveFrames(size_t first, size_t last) {
+    last = std::min(last, GetFramesCount());
+    if (first >= last) {
+        return 0;
+    }
+    m_timestamps.erase(m_timestamps.begin() + first, m_timestamps.begin() + last);
+    m_blendshapeWeights.erase(
+        m_blendshapeWeights.begin() + first * m_blendshapeCount, m_blendshapeWeights.begin() + last * m_blendshapeCount);
+    m_emotionStates.erase(
+        m_emotionStates.begin() + first * m_emotionCount, m_emotionStates.begin() + last * m_emotionCount);
+    m_hasBlendshapeWeights.erase(m_hasBlendshapeWeights.begin() + first, m_hasBlendshapeWeights.begin() + last);
+    m_hasEmotionState.erase(m_hasEmotionState.begin() + first, m_hasEmotionState.begin() + last);
+    rebuildTimeIndex();
+    return last - first;
+}
+
+size_t AnimationTrack::GetMemoryUsage() const {
+    size_t bytes = sizeof(*this);
+    for (auto const &name : m_blendshapeNames) {
+        bytes += sizeof(name) + name.capacity();
+    }
+    for (auto const &name : m_emotionStateNames) {
+        bytes += sizeof(name) + name.capacity();
+    }
+    bytes += capacityBytes(m_timestamps);
+    bytes += capacityBytes(m_blendshapeWeights);
+    bytes += capacityBytes(m_emotionStates);
+    bytes += capacityBytes(m_hasBlendshapeWeights);
+    bytes += capacityBytes(m_hasEmotionState);
+    return bytes;
+}
+
+bool AnimationTrack::WriteClip(std::ostream &out) const {
+    ClipHeader header = {};
+    std::memcpy(header.magic, CLIP_MAGIC, sizeof(CLIP_MAGIC));
+    header.version = CLIP_VERSION;
+    header.frame_count = GetFramesCount();
+    header.blendshape_count = m_blendshapeCount;
+    header.emotion_count = m_emotionCount;
+    header.blendshape_name_count = m_blendshapeNames.size();
+    header.emotion_name_count = m_emotionStateNames.size();
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeNames(out, m_blendshapeNames);
+    writeNames(out, m_emotionStateNames);
+    writeColumn(out, m_timestamps);
+    writeColumn(out, m_blendshapeWeights);
+    writeColumn(out, m_emotionStates);
+    writeColumn(out, m_hasBlendshapeWeights);
+    writeColumn(out, m_hasEmotionState);
+    return static_cast<bool>(out);
+}
+
+bool AnimationTrack::ReadClip(const char *data, size_t size) {
+    ClipReader reader(data, size);
+    ClipHeader header;
+    if (!reader.Read(&header, sizeof(header)) ||
+        std::memcmp(header.magic, CLIP_MAGIC, sizeof(CLIP_MAGIC)) != 0 || header.version != CLIP_VERSION) {
+        return false;
+    }
+    // the columns must fit in the clip before their sizes are multiplied
+    if (header.frame_count > size || header.blendshape_count > size || header.emotion_count > size) {
+        return false;
+    }
+
+    AnimationTrack track;
+    bool valid = reader.ReadNames(header.blendshape_name_count, &track.m_blendshapeNames) &&
+        reader.ReadNames(header.emotion_name_count, &track.m_emotionStateNames) &&
+        reader.ReadColumn(header.frame_count, &track.m_timestamps) &&
+        reader.ReadColumn(header.frame_count * header.blendshape_count, &track.m_blendshapeWeights) &&
+        reader.ReadColumn(header.frame_count * header.emotion_count, &track.m_emotionStates) &&
+        reader.ReadColumn(header.frame_count, &track.m_hasBlendshapeWeights) &&
+        reader.ReadColumn(header.frame_count, &track.m_hasEmotionState) &&
+        reader.AtEnd();
+    if (!valid) {
+        return false;
+    }
+    track.m_blendshapeCount = header.blendshape_count;
+    track.m_emotionCount = header.emotion_count;
+    track.rebuildTimeIndex();
+    *this = std::move(track);
+    return true;
+}
+
+void AnimationTrack::Emit(FrameReceiver *receiver) const {
+    receiver->OnHeader(m_blendshapeNames, m_emotionStateNames);
+    std::vector<AnimDataFrame> batch;
+    for (size_t first = 0; first < GetFramesCount(); first += EMIT_BATCH_SIZE) {
+        size_t last = std::min(first + EMIT_BATCH_SIZE, GetFramesCount());
+        batch.clear();
+        batch.reserve(last - first);
+        for (size_t i = first; i < last; ++i) {
+            // the names are given to OnHeader only
+            AnimDataFrame frame;
+            frame.timestamp = m_timestamps[i];
+            frame.blend_shape_weights = GetBlendshapeWeights(i);
+            frame.emotion_state = GetEmotionState(i);
+            batch.push_back(std::move(frame));
+        }
+        receiver->OnFrames(std::move(batch));
+    }
+}
+
+void AnimationTrack::OnHeader(
+    std::vector<std::string> const &blend_shape_names,
+    std::vector<std::string> const &emotion_state_names) {
+    m_blendshapeNames = blend_shape_names;
+    m_emotionStateNames = emotion_state_names;
+}
+
+void AnimationTrack::OnFrames(std::vector<AnimDataFrame> &&frames) {
+    for (auto const &frame : frames) {
+        AddFrame(frame);
+    }
+}
+
+void AnimationTrack::widen(size_t blendshape_count, size_t emotion_count) {
+    size_t rows = GetFramesCount();
+    if (blendshape_count > m_blendshapeCount) {
+        widenRows(m_blendshapeWeights, rows, m_blendshapeCount, blendshape_count);
+        m_blendshapeCount = blendshape_count;
+        m_blendshapeWeights.reserve(std::max(rows, m_reservedFrames) * m_blendshapeCount);
+    }
+    if (emotion_count > m_emotionCount) {
+        widenRows(m_emotionStates, rows, m_emotionCount, emotion_count);
+        m_emotionCount = emotion_count;
+        m_emotionStates.reserve(std::max(rows, m_reservedFrames) * m_emotionCount);
+    }
+}
+
+void AnimationTrack::setRow(size_t frame_index, AnimDataFrame const &frame) {
+    if (m_blendshapeNames.empty()) {
+        m_blendshapeNames = frame.blend_shape_names;
+    }
+    if (m_emotionStateNames.empty()) {
+        m_emotionStateNames = frame.emotion_state_names;
+    }
+    m_timestamps[frame_index] = frame.timestamp;
+
+    float *weights = m_blendshapeWeights.data() + frame_index * m_blendshapeCount;
+    std::fill_n(std::copy(frame.blend_shape_weights.begin(), frame.blend_shape_weights.end(), weights),
+        m_blendshapeCount - frame.blend_shape_weights.size(), 0.0f);
+    m_hasBlendshapeWeights[frame_index] = !frame.blend_shape_weights.empty();
+
+    float *emotions = m_emotionStates.data() + frame_index * m_emotionCount;
+    std::fill_n(std::copy(frame.emotion_state.begin(), frame.emotion_state.end(), emotions),
+        m_emotionCount - frame.emotion_state.size(), 0.0f);
+    m_hasEmotionState[frame_index] = !frame.emotion_state.empty();
+}
+
+void AnimationTrack::indexFrame(size_t frame_count) {
+    if (frame_count < 2) {
+        m_timeIndexed = false;
+        m_uniformSpacing = false;
+        return;
+    }
+    double delta = m_timestamps[frame_count - 1] - m_timestamps[frame_count - 2];
+    if (frame_count == 2) {
+        m_timeIndexed = delta > 0.0;
+        m_uniformSpacing = true;
+        return;
+    }
+    if (!m_timeIndexed) {
+        return;
+    }
+    if (delta <= 0.0) {
+        m_timeIndexed = false;
+        return;
+    }
+    // the frame must be near where the spacing of the previous frames puts it
+    double interval = (m_timestamps[frame_count - 2] - m_timestamps.front()) / (frame_count - 2);
+    double expected = m_timestamps.front() + interval * (frame_count - 1);
+    if (std::abs(m_timestamps[frame_count - 1] - expected) > UNIFORM_SPACING_TOLERANCE * interval) {
+        m_uniformSpacing = false;
+    }
+}
+
+void AnimationTrack::rebuildTimeIndex() {
+    m_timeIndexed = false;
+    m_uniformSpacing = false;
+    for (size_t count = 2; count <= GetFramesCount(); ++count) {
+        indexFrame(count);
+    }
+}
+
+static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<void *>::is_always_lock_free,
+    "PublishedTrack readers rely on lock-free atomics");
+
+PublishedTrack::PublishedTrack() : m_current(new Version{std::make_shared<AnimationTrack>(), 0}) {
+}
+
+PublishedTrack::PublishedTrack(PublishedTrack const &other) : m_current(new Version(other.load())) {
+}
+
+PublishedTrack &PublishedTrack::operator=(PublishedTrack const &other) {
+    if (this != &other) {
+        Version version = other.load();
+        Publish(version.track, version.time);
+    }
+    return *this;
+}
+
+PublishedTrack::~PublishedTrack() {
+    // no reader may outlive the owner
+    delete m_current.load();
+    for (Version *version : m_retired) {
+        delete version;
+    }
+}
+
+PublishedTrack::Version PublishedTrack::load() const {
+    // a writer releases a replaced version only when it sees no reader counted in after the swap,
+    // so the version loaded here stays alive until the reader counts itself out
+    m_readers.fetch_add(1);
+    Version version = *m_current.load();
+    m_readers.fetch_sub(1);
+    return version;
+}
+
+std::shared_ptr<const AnimationTrack> PublishedTrack::Get() const {
+    return load().track;
+}
+
+long long PublishedTrack::GetPublishedTime() const {
+    return load().time;
+}
+
+void PublishedTrack::Publish(std::shared_ptr<const AnimationTrack> track, long long time) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    publish(new Version{std::move(track), time});
+}
+
+bool PublishedTrack::Edit(std::function<bool(AnimationTrack &)> const &edit, long long time) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    // only writers replace the current version, so it can be read without counting in
+    auto edited = std::make_shared<AnimationTrack>(*m_current.load()->track);
+    if (!edit(*edited)) {
+        return false;
+    }
+    publish(new Version{std::move(edited), time});
+    return true;
+}
+
+size_t PublishedTrack::GetRetiredCount() {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    return m_retired.size();
+}
+
+void PublishedTrack::publish(Version *version) {
+    m_retired.push_back(m_current.exchange(version));
+    if (m_readers.load() != 0) {
+        // a reader may still be copying a retired version; a later publish releases it
+        return;
+    }
+    for (Version *retired : m_retired) {
+        delete retired;
+    }
+    m_retired.clear();
+}
+
+} // namespace mace
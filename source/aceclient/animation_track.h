@@ -0,0 +1,174 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "aceclient.h"
+#include "array_view.h"
+#include "frame_receiver.h"
+
+namespace mace {
+
+// Largest deviation of a frame from the even spacing of the track, relative to the interval,
+// for the track to be indexed as evenly spaced.
+const double UNIFORM_SPACING_TOLERANCE = 0.1;
+
+// Animation frames stored by column instead of as a vector of AnimDataFrame.
+// The names are stored once for the whole track, and the blendshape weights and emotions are
+// contiguous row-major matrices with one row per frame. Rows narrower than the widest row are
+// padded with zeros; a frame without weights or emotions keeps that state.
+class AnimationTrack : public FrameReceiver {
+public:
+    AnimationTrack() = default;
+
+    void Clear();
+    // Reserve the rows for frame_count frames of the current width.
+    void Reserve(size_t frame_count);
+
+    void SetBlendshapeNames(std::vector<std::string> const &names);
+    std::vector<std::string> const &GetBlendshapeNames() const;
+    void SetEmotionStateNames(std::vector<std::string> const &names);
+    std::vector<std::string> const &GetEmotionStateNames() const;
+
+    size_t GetFramesCount() const;
+    // the width of a row
+    size_t GetBlendshapeCount() const;
+    size_t GetEmotionCount() const;
+
+    double GetTimestamp(size_t frame_index) const;
+    // Frames are indexed by their timestamps once there are two or more of them and the
+    // timestamps increase; evenly spaced frames are found in constant time, others by a binary
+    // search.
+    bool HasTimeIndex() const;
+    bool HasUniformSpacing() const;
+    // the average interval between frames, or 0 without a time index
+    double GetFrameInterval() const;
+    // The fractional frame index of a time, e.g. 2.5 halfway between the frames 2 and 3. Times out
+    // of the track continue with the average interval. Only meaningful with a time index.
+    double GetFramePosition(double seconds) const;
+
+    bool HasBlendshapeWeights(size_t frame_index) const;
+    bool HasEmotionState(size_t frame_index) const;
+    // Rows of GetBlendshapeCount() and GetEmotionCount() values; nullptr when the frame has none.
+    const float *GetBlendshapeRow(size_t frame_index) const;
+    const float *GetEmotionRow(size_t frame_index) const;
+    // The same rows as views; empty when the frame has none.
+    ArrayView<const float> GetBlendshapeView(size_t frame_index) const;
+    ArrayView<const float> GetEmotionView(size_t frame_index) const;
+    std::vector<float> GetBlendshapeWeights(size_t frame_index) const;
+    std::vector<float> GetEmotionState(size_t frame_index) const;
+
+    // Frames are copied in and out; the names come from the track.
+    AnimDataFrame GetFrame(size_t frame_index) const;
+    void AddFrame(AnimDataFrame const &frame);
+    bool InsertFrame(size_t frame_index, AnimDataFrame const &frame);
+    bool ReplaceFrame(size_t frame_index, AnimDataFrame const &frame);
+    size_t RemoveFrames(size_t first, size_t last);
+
+    // Bytes held by the track, including reserved capacity.
+    size_t GetMemoryUsage() const;
+
+    // A compact binary copy of the track: a header, the names, then the columns as stored.
+    // Clips are only read back on machines of the same byte order.
+    bool WriteClip(std::ostream &out) const;
+    // Replaces the track with a clip, e.g. a mapped file; false when the clip is not valid.
+    bool ReadClip(const char *data, size_t size);
+    // Replays the track to a receiver: the header, then the frames in batches. OnComplete is not
+    // called.
+    void Emit(FrameReceiver *receiver) const;
+
+    // FrameReceiver
+    void OnHeader(
+        std::vector<std::string> const &blend_shape_names,
+        std::vector<std::string> const &emotion_state_names) override;
+    void OnFrames(std::vector<AnimDataFrame> &&frames) override;
+
+protected:
+    std::vector<std::string> m_blendshapeNames;
+    std::vector<std::string> m_emotionStateNames;
+
+    size_t m_blendshapeCount = 0;
+    size_t m_emotionCount = 0;
+    size_t m_reservedFrames = 0;
+    std::vector<double> m_timestamps;
+    std::vector<float> m_blendshapeWeights;
+    std::vector<float> m_emotionStates;
+    std::vector<uint8_t> m_hasBlendshapeWeights;
+    std::vector<uint8_t> m_hasEmotionState;
+    bool m_timeIndexed = false;
+    bool m_uniformSpacing = false;
+
+    void widen(size_t blendshape_count, size_t emotion_count);
+    void setRow(size_t frame_index, AnimDataFrame const &frame);
+    // Updates the time index for the last of the first frame_count frames.
+    void indexFrame(size_t frame_count);
+    void rebuildTimeIndex();
+};
+
+// The current version of a track shared between one writer at a time and any number of readers.
+// A new version is built off to the side and published with an atomic pointer swap. Readers are
+// lock-free: they count themselves in, load the pointer and copy the shared_ptr it holds, without
+// any mutex; a reader holding a version keeps it alive and unchanged. A replaced version is
+// released by a later publish, or the destructor, once no reader is counted in. Copies start from
+// the same version.
+class PublishedTrack {
+public:
+    PublishedTrack();
+    PublishedTrack(PublishedTrack const &other);
+    PublishedTrack &operator=(PublishedTrack const &other);
+    ~PublishedTrack();
+
+    std::shared_ptr<const AnimationTrack> Get() const;
+    // The time of the last publish, 0 before the first one.
+    long long GetPublishedTime() const;
+
+    void Publish(std::shared_ptr<const AnimationTrack> track, long long time);
+    // Publishes a copy of the current version changed by edit, unless edit returns false.
+    bool Edit(std::function<bool(AnimationTrack &)> const &edit, long long time);
+    // Replaced versions not released yet, because readers were counted in at the time.
+    size_t GetRetiredCount();
+
+protected:
+    struct Version {
+        std::shared_ptr<const AnimationTrack> track;
+        long long time = 0;
+    };
+
+    std::atomic<Version *> m_current;
+    mutable std::atomic<size_t> m_readers{0};
+    // orders the writers, so no edit is lost to a concurrent publish, and guards m_retired
+    std::mutex m_writeMutex;
+    std::vector<Version *> m_retired;
+
+    Version load() const;
+    // Swaps in a new version and releases the retired ones no reader can see; m_writeMutex must be held.
+    void publish(Version *version);
+};
+
+} // namespace mace
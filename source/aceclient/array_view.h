@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace mace {
+
+// A non-owning view over contiguous values, e.g. a row of an AnimationTrack.
+// The view is only valid while the storage it points to is alive and unmodified.
+template <typename T>
+class ArrayView {
+public:
+    using value_type = std::remove_const_t<T>;
+    using iterator = T *;
+
+    ArrayView() = default;
+    ArrayView(T *data, size_t size) : m_data(data), m_size(data == nullptr ? 0 : size) {}
+    template <typename U, typename = std::enable_if_t<std::is_same<value_type, U>::value && std::is_const<T>::value>>
+    ArrayView(std::vector<U> const &values) : m_data(values.data()), m_size(values.size()) {}
+
+    T *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    iterator begin() const { return m_data; }
+    iterator end() const { return m_data + m_size; }
+    T &operator[](size_t index) const { return m_data[index]; }
+
+    std::vector<value_type> ToVector() const { return std::vector<value_type>(begin(), end()); }
+
+protected:
+    T *m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace mace
@@ -19,82 +19,67 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 #include "audio.h"
+#include "audio_source.h"
 #include "logger.h"
+#include "resampler.h"
+#include "simd.h"
 
 #include <AudioFile.h>
 
 #include <algorithm>
 #include <cmath>
 #include <limits>
-#include <numeric>
+#include <memory>
 #include <vector>
 
 #pragma warning(disable : 5038)
 #pragma warning(disable : 4456)
 
 
-std::vector<int16_t> get_file_wav_content_int16(const std::string& filename) {
-    /*
-    A simple wave file reader with resampling - not preserving signal quality.
-        - Returns audio samples at 16k samplerate int16 bitdepth.
-    */
-
-    // Read 8, 16, 24, 32 bits PCM(int) and 32 bits IEEEFLOAT and map to [-1.0, 1.0] values
-    //      NOTE: AudioFile<int> cannot read IEEEFLOAT files.
-    AudioFile<float> audio(filename);
-
+std::vector<int16_t> get_file_wav_content_int16(const std::string& filename, size_t samplerate) {
     // NOTE: The current A2F service accepts only int16 audio samples.
-    std::vector<int16_t> samples;
-
-    // no audio data
-    if(audio.getNumChannels() == 0 || audio.getLengthInSeconds() == 0){
-        LOG_ERROR("No audio samples from " + filename);
-        return {};
-    }
-
-    if(audio.getSampleRate() != DefaultSampleRate){
-        // TODO: Need a better resampling.
-        // NOTE: Temporary resampling (only down-sampling is allowed.)
-        if(audio.getSampleRate() < DefaultSampleRate) {
-            LOG_ERROR("Source samplerate is too low (< 16000): " + filename);
+    auto wav = std::make_shared<mace::WavFileAudioSource>();
+    if (wav->Open(filename) == AceClientStatus::OK) {
+        if (wav->GetSampleRate() < samplerate) {
+            // no upsampling is supported; decoding the file as floats would not help
+            LOG_ERROR("Sample rate of " + filename + " is below " + std::to_string(samplerate) + " Hz");
             return {};
         }
-
-        size_t out_size = audio.samples[0].size() * DefaultSampleRate / audio.getSampleRate();
-
-        int32_t min_resample = 0, max_resample = 0;
-        for (size_t i = 0; i < out_size; i++) {
-            size_t k = std::min(
-                std::max((size_t) 0, i * audio.getSampleRate() / DefaultSampleRate),
-                audio.samples[0].size() - 1
-            );
-            float sample_f = audio.samples[0][k];
-            // float sample_f = (audio.samples[0][k] + audio.samples[0][k+1] + audio.samples[0][k+2]) / 3.0f;
-
-            int32_t sample_i = static_cast<int32_t> (std::min(32767.0f, sample_f * 32768.0f));
-            samples.push_back(sample_i);
-
-        }
-    }
-    else {
-        for (int i = 0; i < audio.samples[0].size(); i++) {
-            samples.push_back(static_cast<int16_t> (std::min(32767.0f, audio.samples[0][i] * 32768.0f)));
+        std::shared_ptr<const mace::AudioSource> source = wav;
+        if (wav->GetSampleRate() != samplerate) {
+            source = std::make_shared<mace::ResampledAudioSource>(wav, samplerate);
         }
+        // s16le mono at the target rate is a plain copy of the mapped data
+        std::vector<int16_t> samples(source->GetSampleCount());
+        source->Read(0, samples.data(), samples.size());
+        return samples;
     }
 
-    return samples;
+    // files the WAV reader cannot map: decode to floats first
+    std::vector<float> samples_f = get_file_wav_content(filename, samplerate);
+    if (samples_f.empty()) {
+        LOG_ERROR("No audio samples from " + filename);
+        return {};
+    }
+    return convert_float_to_int16(samples_f);
 }
 
 std::vector<int16_t> convert_float_to_int16(const std::vector<float> &input) {
     /*Convert sample values from float to int16_t
     */
-    std::vector<int16_t> output;
-    for (float sample: input) {
-        output.push_back(static_cast<int16_t> (std::min(32767.0f, sample * 32768.0f)));
-    }
+    std::vector<int16_t> output(input.size());
+    convert_float_to_int16(input.data(), output.data(), input.size());
     return output;
 }
 
+void convert_float_to_int16(const float *input, int16_t *output, size_t count) {
+    mace::FloatToInt16(input, output, count);
+}
+
+void convert_int16_to_float(const int16_t *input, float *output, size_t count) {
+    mace::Int16ToFloat(input, output, count);
+}
+
 std::vector<float> get_file_wav_content(const std::string& filename, size_t samplerate) {
     AudioFile<float> audio(filename);  // can read PCM and IEEE FLOAT in value range [-1.0, 1.0]
 
@@ -110,18 +95,17 @@ std::vector<float> get_file_wav_content(const std::string& filename, size_t samp
 }
 
 std::vector<float> resample(const std::vector<float>& input, int targetSampleRate, int originalSampleRate) {
-    const int multiple = targetSampleRate / originalSampleRate;
-    if(multiple * targetSampleRate == originalSampleRate) // multiple of source; 48 khz -> 16k, 24k
-    {
-        return downsample(input, targetSampleRate, originalSampleRate);
+    if (targetSampleRate <= 0 || originalSampleRate <= 0) {
+        return {};
     }
-
-    size_t lcm = std::lcm(originalSampleRate, targetSampleRate);
-    if (lcm > 1e10) {
-        return {}; // it is too expensive to resample. not supported
+    if (targetSampleRate == originalSampleRate) {
+        return input;
     }
 
-    return downsample(upsample(input, lcm, originalSampleRate), targetSampleRate, lcm);
+    mace::PolyphaseResampler resampler(originalSampleRate, targetSampleRate);
+    std::vector<float> output(resampler.GetOutputCount(input.size()));
+    resampler.Process(input.data(), 0, input.size(), 0, output.size(), output.data());
+    return output;
 }
 
 std::vector<float> upsample(const std::vector<float>& input, int targetSampleRate, int originalSampleRate) {
@@ -31,9 +31,18 @@ constexpr size_t DefaultBufferOffset = 4160;
 constexpr size_t Int16Max = std::numeric_limits<int16_t>::max(); // = 32767 or max(32767, val * 32768)
 constexpr size_t Int16Scale = 1 << 15; // 32768
 
-std::vector<int16_t> get_file_wav_content_int16(const std::string& filename);  // deprecated
+// Int16 samples of the first channel. Mono PCM16 WAV files at the target rate are copied as is, and other
+// WAV files are converted block by block; only files that the WAV reader cannot map are decoded as floats.
+// Files below the target rate give no samples, as upsampling is not supported.
+std::vector<int16_t> get_file_wav_content_int16(const std::string& filename, size_t samplerate=DefaultSampleRate);
+// Saturated to the int16 range on both sides.
 std::vector<int16_t> convert_float_to_int16(const std::vector<float> &input);
+// Into buffers of the caller, with the vectorized kernels of simd.h.
+void convert_float_to_int16(const float *input, int16_t *output, size_t count);
+void convert_int16_to_float(const int16_t *input, float *output, size_t count);
+// Band-limited with mace::PolyphaseResampler; gives ceil(size * target / original) samples.
 std::vector<float> resample(const std::vector<float>& input, int targetSampleRate, int originalSampleRate);
+// Linear interpolation and plain decimation, without filtering.
 std::vector<float> upsample(const std::vector<float>& input, int targetSampleRate, int originalSampleRate);
 std::vector<float> downsample(const std::vector<float>& input, int targetSampleRate, int originalSampleRate);
 std::vector<float> get_file_wav_content(const std::string& filename, size_t samplerate=DefaultSampleRate);
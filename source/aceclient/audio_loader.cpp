@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "audio_loader.h"
+#include "audio_registry.h"
+#include "logger.h"
+
+namespace {
+    typedef std::shared_ptr<std::atomic<bool>> CancelToken;
+
+    bool isCancelled(CancelToken const &token) {
+        return token && token->load();
+    }
+
+    mace::LoadedAudio loadAudio(std::string const &path, size_t samplerate, CancelToken const &token) {
+        mace::LoadedAudio audio;
+        audio.path = path;
+        if (isCancelled(token)) {
+            audio.status = ERROR_CANCELLED;
+            return audio;
+        }
+
+        // WAV files are mapped and read block by block while uploading, and downsampled as they are read
+        auto wav = std::make_shared<mace::WavFileAudioSource>();
+        if (wav->Open(path) == AceClientStatus::OK && wav->GetSampleRate() >= samplerate) {
+            if (wav->GetSampleRate() == samplerate) {
+                audio.source = wav;
+            } else {
+                audio.source = std::make_shared<mace::ResampledAudioSource>(wav, samplerate);
+            }
+        } else {
+            std::vector<float> buffer_f = get_file_wav_content(path, samplerate);
+            if (isCancelled(token)) {
+                audio.status = ERROR_CANCELLED;
+                return audio;
+            }
+            std::vector<int16_t> buffer = convert_float_to_int16(buffer_f);
+            audio.source = std::make_shared<mace::MemoryAudioSource>(std::move(buffer), samplerate);
+        }
+
+        if (audio.source->GetSampleCount() < 1) {
+            LOG_ERROR("No audio samples from the file: " << path);
+            audio.source.reset();
+            audio.status = ERROR_INVALID_INPUT;
+            return audio;
+        }
+        audio.status = OK;
+        return audio;
+    }
+
+    std::shared_future<mace::LoadedAudio> submit(std::string const &path, size_t samplerate,
+        CancelToken const &token, bool useRegistry, mace::AudioLoader::Callback onLoaded) {
+        auto promise = std::make_shared<std::promise<mace::LoadedAudio>>();
+        std::shared_future<mace::LoadedAudio> result = promise->get_future().share();
+        mace::AudioLoaderPool::Instance().Submit([path, samplerate, token, useRegistry, onLoaded, promise]() {
+            mace::LoadedAudio audio;
+            if (useRegistry && !isCancelled(token)) {
+                audio = mace::AudioRegistry::Instance().Get(path, samplerate);
+            } else {
+                audio = loadAudio(path, samplerate, token);
+            }
+            promise->set_value(audio);
+            if (onLoaded && audio.status != ERROR_CANCELLED) {
+                onLoaded(audio);
+            }
+        });
+        return result;
+    }
+} // namespace
+
+namespace mace {
+
+LoadedAudio LoadAudio(std::string const &path, size_t samplerate) {
+    return loadAudio(path, samplerate, nullptr);
+}
+
+std::shared_future<LoadedAudio> LoadWavAsync(std::string const &path, size_t samplerate) {
+    return submit(path, samplerate, nullptr, false, nullptr);
+}
+
+AudioLoader::~AudioLoader() {
+    Cancel();
+}
+
+std::shared_future<LoadedAudio> AudioLoader::Load(std::string const &path, size_t samplerate, Callback onLoaded) {
+    auto token = std::make_shared<std::atomic<bool>>(false);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_cancelled) {
+            m_cancelled->store(true);
+        }
+        m_cancelled = token;
+    }
+    return submit(path, samplerate, token, m_useRegistry, onLoaded);
+}
+
+void AudioLoader::Cancel() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cancelled) {
+        m_cancelled->store(true);
+        m_cancelled.reset();
+    }
+}
+
+void AudioLoader::SetUseRegistry(bool useRegistry) {
+    m_useRegistry = useRegistry;
+}
+
+bool AudioLoader::GetUseRegistry() const {
+    return m_useRegistry;
+}
+
+void AudioLoader::Shutdown() {
+    AudioLoaderPool::Instance().Shutdown();
+}
+
+AudioLoaderPool &AudioLoaderPool::Instance() {
+    static AudioLoaderPool pool;
+    return pool;
+}
+
+AudioLoaderPool::~AudioLoaderPool() {
+    Shutdown();
+}
+
+void AudioLoaderPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+        if (m_workers.size() < AUDIO_LOADER_WORKERS) {
+            m_workers.emplace_back(&AudioLoaderPool::run, this);
+        }
+    }
+    m_wake.notify_one();
+}
+
+void AudioLoaderPool::Shutdown() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        workers.swap(m_workers);
+    }
+    m_wake.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    // the queue is drained; a later load starts the workers again
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = false;
+}
+
+void AudioLoaderPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace mace
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "aceclient.h"
+#include "audio.h"
+#include "audio_source.h"
+
+namespace mace {
+
+// The number of threads decoding audio files in the background.
+const size_t AUDIO_LOADER_WORKERS = 2;
+
+struct LoadedAudio {
+    AceClientStatus status = ERROR_UNKNOWN;
+    std::string path;
+    std::shared_ptr<const AudioSource> source;
+};
+
+// Opens an audio file as a mono source at the given rate. WAV files at or above the rate are mapped
+// and downsampled as they are read; other files are decoded in full.
+// Returns ERROR_INVALID_INPUT when the file cannot be read or has no samples.
+LoadedAudio LoadAudio(std::string const &path, size_t samplerate = DefaultSampleRate);
+
+// Loads an audio file on the worker threads.
+std::shared_future<LoadedAudio> LoadWavAsync(std::string const &path, size_t samplerate = DefaultSampleRate);
+
+// Loads audio files on the worker threads for one consumer. A newer Load supersedes the older one:
+// if the older file is not loaded yet, it is skipped and its future reports ERROR_CANCELLED.
+class AudioLoader {
+public:
+    // Called on a worker thread once a load, which was not cancelled, finishes.
+    typedef std::function<void(LoadedAudio const &)> Callback;
+
+    AudioLoader() = default;
+    ~AudioLoader();
+
+    std::shared_future<LoadedAudio> Load(std::string const &path, size_t samplerate = DefaultSampleRate,
+        Callback onLoaded = nullptr);
+    void Cancel();
+
+    // Loads through AudioRegistry, sharing in-memory copies of unchanged files with other consumers.
+    void SetUseRegistry(bool useRegistry);
+    bool GetUseRegistry() const;
+
+    // Stops the worker threads after the queued loads. Call before unloading the library.
+    static void Shutdown();
+
+protected:
+    std::mutex m_mutex;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+    std::atomic<bool> m_useRegistry{false};
+};
+
+// Process-wide worker threads of the audio loaders, started on the first load.
+class AudioLoaderPool {
+public:
+    static AudioLoaderPool &Instance();
+    ~AudioLoaderPool();
+
+    void Submit(std::function<void()> task);
+    void Shutdown();
+
+protected:
+    AudioLoaderPool() = default;
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<std::thread> m_workers;
+    bool m_stopping = false;
+};
+
+} // namespace mace
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "audio_registry.h"
+#include "logger.h"
+
+#include <filesystem>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace mace {
+
+AudioRegistry &AudioRegistry::Instance() {
+    static AudioRegistry registry;
+    return registry;
+}
+
+LoadedAudio AudioRegistry::Get(std::string const &path, size_t samplerate) {
+    std::error_code error;
+    fs::path file = fs::u8path(path);
+    fs::path canonical = fs::canonical(file, error);
+    if (error) {
+        // missing files are not registered; let the loader report them
+        return LoadAudio(path, samplerate);
+    }
+    Stamp stamp;
+    stamp.modified = static_cast<long long>(fs::last_write_time(canonical, error).time_since_epoch().count());
+    stamp.size = fs::file_size(canonical, error);
+    Key key(canonical.u8string(), samplerate);
+
+    LoadedAudio audio;
+    audio.path = path;
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iter = m_entries.find(key);
+        if (iter != m_entries.end()) {
+            if (iter->second.stamp == stamp) {
+                audio.source = iter->second.source.lock();
+            } else {
+                changed = true;
+            }
+        }
+        if (audio.source) {
+            m_stats.hits++;
+            audio.status = AceClientStatus::OK;
+            return audio;
+        }
+    }
+
+    // decode outside of the lock so other files are not held up
+    audio = LoadAudio(path, samplerate);
+    if (audio.status != AceClientStatus::OK) {
+        return audio;
+    }
+    audio.source = snapshot(audio.source);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry &entry = m_entries[key];
+    if (entry.stamp == stamp) {
+        // another consumer loaded the same file meanwhile
+        if (auto registered = entry.source.lock()) {
+            m_stats.hits++;
+            audio.source = registered;
+            return audio;
+        }
+    }
+    LOG_DEBUG("AudioRegistry: Loaded " << path << " at " << samplerate << " Hz");
+    m_stats.loads++;
+    if (changed) {
+        m_stats.reloads++;
+    }
+    entry.stamp = stamp;
+    entry.source = audio.source;
+    prune();
+    return audio;
+}
+
+void AudioRegistry::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+AudioRegistryStats AudioRegistry::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    prune();
+    AudioRegistryStats stats = m_stats;
+    stats.files = m_entries.size();
+    return stats;
+}
+
+void AudioRegistry::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = AudioRegistryStats();
+}
+
+std::shared_ptr<const AudioSource> AudioRegistry::snapshot(std::shared_ptr<const AudioSource> const &source) {
+    if (dynamic_cast<const MemoryAudioSource *>(source.get())) {
+        // decoded in full already
+        return source;
+    }
+    std::vector<int16_t> samples(source->GetSampleCount());
+    size_t copied = 0;
+    while (copied < samples.size()) {
+        size_t count = source->Read(copied, samples.data() + copied, samples.size() - copied);
+        if (count == 0) {
+            break;
+        }
+        copied += count;
+    }
+    samples.resize(copied);
+    return std::make_shared<MemoryAudioSource>(std::move(samples), source->GetSampleRate());
+}
+
+void AudioRegistry::prune() {
+    for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+        if (iter->second.source.expired()) {
+            iter = m_entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+} // namespace mace
@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "audio.h"
+#include "audio_loader.h"
+#include "audio_source.h"
+
+namespace mace {
+
+struct AudioRegistryStats {
+    size_t hits = 0;
+    size_t loads = 0;
+    // loads of a file that changed since it was registered
+    size_t reloads = 0;
+    // current contents
+    size_t files = 0;
+};
+
+// Process-wide registry of loaded audio files keyed by (canonical path, target rate), so consumers
+// of the same file share one immutable source. The registered sources are copies of the samples in
+// memory rather than file mappings, so rewriting or truncating a file does not change or invalidate
+// the sources already handed out, and the file is not kept open (nor locked on Windows).
+// The registry does not own the sources: a file is reloaded once nobody holds it, or when its
+// modification time or size changes.
+class AudioRegistry {
+public:
+    static AudioRegistry &Instance();
+
+    // Same as LoadAudio, but returns the registered source when the file has not changed.
+    LoadedAudio Get(std::string const &path, size_t samplerate = DefaultSampleRate);
+    void Clear();
+
+    AudioRegistryStats GetStats();
+    void ResetStats();
+
+protected:
+    AudioRegistry() = default;
+
+    typedef std::tuple<std::string, size_t> Key;
+
+    struct Stamp {
+        long long modified = 0;
+        uintmax_t size = 0;
+
+        bool operator==(Stamp const &other) const {
+            return modified == other.modified && size == other.size;
+        }
+    };
+
+    struct Entry {
+        Stamp stamp;
+        std::weak_ptr<const AudioSource> source;
+    };
+
+    std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+    AudioRegistryStats m_stats;
+
+    // Drops the entries of released sources; m_mutex must be held.
+    void prune();
+    // Copies the samples of a loaded source into memory.
+    static std::shared_ptr<const AudioSource> snapshot(std::shared_ptr<const AudioSource> const &source);
+};
+
+} // namespace mace
@@ -0,0 +1,340 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "audio_source.h"
+#include "hash.h"
+#include "logger.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const uint16_t WAVE_FORMAT_PCM = 0x0001;
+    const uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    // WAV files are little endian
+    uint16_t readUint16(const char *data) {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+        return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    uint32_t readUint32(const char *data) {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    int16_t saturate(double value) {
+        return static_cast<int16_t>(std::min(32767.0, std::max(-32768.0, value)));
+    }
+
+    // One sample at data, with full scale mapped to the int16 range.
+    int16_t convertSample(const char *data, size_t bits, bool isFloat) {
+        if (isFloat) {
+            if (bits == 32) {
+                float value;
+                std::memcpy(&value, data, sizeof(value));
+                return saturate(value * 32768.0);
+            }
+            double value;
+            std::memcpy(&value, data, sizeof(value));
+            return saturate(value * 32768.0);
+        }
+        switch (bits) {
+        case 8:
+            // unsigned, centered at 128
+            return static_cast<int16_t>((static_cast<int>(static_cast<unsigned char>(data[0])) - 128) * 256);
+        case 16:
+            return static_cast<int16_t>(readUint16(data));
+        case 24: {
+            int32_t value = static_cast<int32_t>(
+                static_cast<uint32_t>(static_cast<unsigned char>(data[0])) << 8 |
+                static_cast<uint32_t>(static_cast<unsigned char>(data[1])) << 16 |
+                static_cast<uint32_t>(static_cast<unsigned char>(data[2])) << 24);
+            return static_cast<int16_t>(value / 65536);
+        }
+        default:
+            return static_cast<int16_t>(static_cast<int32_t>(readUint32(data)) / 65536);
+        }
+    }
+
+    bool isSupported(size_t bits, bool isFloat) {
+        if (isFloat) {
+            return bits == 32 || bits == 64;
+        }
+        return bits == 8 || bits == 16 || bits == 24 || bits == 32;
+    }
+}
+
+namespace mace {
+
+uint64_t AudioSource::GetContentHash() const {
+    const int16_t *samples = GetSamples();
+    std::vector<int16_t> block;
+    if (!samples) {
+        block.resize(std::min(GetSampleCount(), AUDIO_SOURCE_BLOCK_SIZE));
+    }
+    uint64_t hash = 0;
+    for (size_t first = 0; first < GetSampleCount(); first += AUDIO_SOURCE_BLOCK_SIZE) {
+        size_t count = std::min(AUDIO_SOURCE_BLOCK_SIZE, GetSampleCount() - first);
+        const int16_t *data = samples ? samples + first : block.data();
+        if (!samples) {
+            count = Read(first, block.data(), count);
+        }
+        hash = Hash64(data, count * sizeof(int16_t), hash);
+    }
+    return hash;
+}
+
+MemoryAudioSource::MemoryAudioSource(const int16_t *samples, size_t sample_count, size_t sample_rate)
+    : m_samples(samples), m_sampleCount(sample_count), m_sampleRate(sample_rate) {}
+
+MemoryAudioSource::MemoryAudioSource(std::vector<int16_t> &&samples, size_t sample_rate)
+    : m_owned(std::move(samples)), m_samples(m_owned.data()), m_sampleCount(m_owned.size()),
+      m_sampleRate(sample_rate) {}
+
+size_t MemoryAudioSource::GetSampleRate() const {
+    return m_sampleRate;
+}
+
+size_t MemoryAudioSource::GetSampleCount() const {
+    return m_sampleCount;
+}
+
+size_t MemoryAudioSource::Read(size_t first, int16_t *out, size_t count) const {
+    if (first >= m_sampleCount) {
+        return 0;
+    }
+    count = std::min(count, m_sampleCount - first);
+    std::memcpy(out, m_samples + first, count * sizeof(int16_t));
+    return count;
+}
+
+const int16_t *MemoryAudioSource::GetSamples() const {
+    return m_samples;
+}
+
+AudioSourceRange::AudioSourceRange(AudioSource const &source, size_t first, size_t count)
+    : m_source(source) {
+    size_t sampleCount = source.GetSampleCount();
+    m_first = std::min(first, sampleCount);
+    m_count = std::min(count, sampleCount - m_first);
+}
+
+size_t AudioSourceRange::GetSampleRate() const {
+    return m_source.GetSampleRate();
+}
+
+size_t AudioSourceRange::GetSampleCount() const {
+    return m_count;
+}
+
+size_t AudioSourceRange::Read(size_t first, int16_t *out, size_t count) const {
+    if (first >= m_count) {
+        return 0;
+    }
+    return m_source.Read(m_first + first, out, std::min(count, m_count - first));
+}
+
+const int16_t *AudioSourceRange::GetSamples() const {
+    const int16_t *samples = m_source.GetSamples();
+    return samples ? samples + m_first : nullptr;
+}
+
+ResampledAudioSource::ResampledAudioSource(std::shared_ptr<const AudioSource> source, size_t sample_rate)
+    : m_source(std::move(source)), m_resampler(m_source->GetSampleRate(), sample_rate),
+      m_sampleCount(m_resampler.GetOutputCount(m_source->GetSampleCount())) {}
+
+size_t ResampledAudioSource::GetSampleRate() const {
+    return m_resampler.GetTargetRate();
+}
+
+size_t ResampledAudioSource::GetSampleCount() const {
+    return m_sampleCount;
+}
+
+size_t ResampledAudioSource::Read(size_t first, int16_t *out, size_t count) const {
+    if (first >= m_sampleCount) {
+        return 0;
+    }
+    count = std::min(count, m_sampleCount - first);
+    int64_t const sourceCount = static_cast<int64_t>(m_source->GetSampleCount());
+    std::lock_guard<std::mutex> lock(m_scratchMutex);
+    std::vector<int16_t> &samples = m_scratchSamples;
+    std::vector<float> &input = m_scratchInput;
+    std::vector<float> &output = m_scratchOutput;
+    for (size_t done = 0; done < count; ) {
+        size_t blockCount = std::min(count - done, AUDIO_SOURCE_BLOCK_SIZE);
+        int64_t inputFirst, inputLast;
+        m_resampler.GetInputRange(first + done, blockCount, &inputFirst, &inputLast);
+        inputFirst = std::max<int64_t>(inputFirst, 0);
+        inputLast = std::min(inputLast, sourceCount);
+
+        samples.resize(static_cast<size_t>(std::max<int64_t>(inputLast - inputFirst, 0)));
+        samples.resize(m_source->Read(static_cast<size_t>(inputFirst), samples.data(), samples.size()));
+        input.resize(samples.size());
+        Int16ToFloat(samples.data(), input.data(), samples.size());
+        output.resize(blockCount);
+        m_resampler.Process(input.data(), inputFirst, input.size(), first + done, blockCount, output.data());
+        FloatToInt16(output.data(), out + done, blockCount);
+        done += blockCount;
+    }
+    return count;
+}
+
+uint64_t ResampledAudioSource::GetContentHash() const {
+    uint64_t const resampling[] = {
+        RESAMPLER_VERSION, m_source->GetSampleRate(), m_resampler.GetTargetRate(), m_resampler.GetTapCount(),
+    };
+    return Hash64(resampling, sizeof(resampling), m_source->GetContentHash());
+}
+
+AceClientStatus WavFileAudioSource::Open(std::string const &path, size_t channel) {
+    Close();
+    if (!m_file.Open(path)) {
+        LOG_ERROR("Unable to open " << path);
+        return AceClientStatus::ERROR_INVALID_INPUT;
+    }
+    const char *data = m_file.GetData();
+    size_t size = m_file.GetSize();
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+        LOG_ERROR("Not a WAV file: " << path);
+        Close();
+        return AceClientStatus::ERROR_INVALID_INPUT;
+    }
+
+    uint16_t format = 0;
+    size_t channelCount = 0, sampleRate = 0, bits = 0;
+    const char *samples = nullptr;
+    size_t dataSize = 0;
+    // chunks are word aligned
+    for (size_t offset = 12; offset + 8 <= size; ) {
+        const char *chunk = data + offset;
+        size_t chunkSize = readUint32(chunk + 4);
+        size_t available = size - offset - 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16 && chunkSize <= available) {
+            format = readUint16(chunk + 8);
+            channelCount = readUint16(chunk + 10);
+            sampleRate = readUint32(chunk + 12);
+            bits = readUint16(chunk + 22);
+            if (format == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40) {
+                // the format is in the first bytes of the sub format GUID
+                format = readUint16(chunk + 32);
+            }
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            samples = chunk + 8;
+            // streamed files may leave the size unset; the data then extends to the end of the file
+            dataSize = std::min(chunkSize, available);
+            break;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    bool isFloat = format == WAVE_FORMAT_IEEE_FLOAT;
+    if (samples == nullptr || (format != WAVE_FORMAT_PCM && !isFloat) || !isSupported(bits, isFloat) ||
+        channelCount == 0 || sampleRate == 0) {
+        LOG_ERROR("Unsupported WAV format " << format << " with " << bits << " bits: " << path);
+        Close();
+        return AceClientStatus::ERROR_INVALID_INPUT;
+    }
+    if (channel >= channelCount) {
+        LOG_ERROR("No channel " << channel << " in " << path);
+        Close();
+        return AceClientStatus::ERROR_INVALID_INPUT;
+    }
+
+    m_channelCount = channelCount;
+    m_sampleRate = sampleRate;
+    m_bitsPerSample = bits;
+    m_float = isFloat;
+    m_channel = channel;
+    m_data = samples + channel * (bits / 8);
+    m_sampleCount = dataSize / frameSize();
+    return AceClientStatus::OK;
+}
+
+void WavFileAudioSource::Close() {
+    m_file.Close();
+    m_data = nullptr;
+    m_sampleCount = 0;
+    m_sampleRate = 0;
+    m_channelCount = 0;
+    m_bitsPerSample = 0;
+    m_float = false;
+    m_channel = 0;
+}
+
+bool WavFileAudioSource::IsOpen() const {
+    return m_data != nullptr;
+}
+
+size_t WavFileAudioSource::GetSampleRate() const {
+    return m_sampleRate;
+}
+
+size_t WavFileAudioSource::GetSampleCount() const {
+    return m_sampleCount;
+}
+
+size_t WavFileAudioSource::Read(size_t first, int16_t *out, size_t count) const {
+    if (first >= m_sampleCount) {
+        return 0;
+    }
+    count = std::min(count, m_sampleCount - first);
+    size_t stride = frameSize();
+    const char *data = m_data + first * stride;
+    if (m_bitsPerSample == 16 && !m_float && m_channelCount == 1) {
+        std::memcpy(out, data, count * sizeof(int16_t));
+        return count;
+    }
+    for (size_t i = 0; i < count; ++i, data += stride) {
+        out[i] = convertSample(data, m_bitsPerSample, m_float);
+    }
+    return count;
+}
+
+const int16_t *WavFileAudioSource::GetSamples() const {
+    // the samples can be used in place when they are stored as they are read
+    bool aligned = reinterpret_cast<uintptr_t>(m_data) % alignof(int16_t) == 0;
+    if (m_bitsPerSample == 16 && !m_float && m_channelCount == 1 && aligned) {
+        return reinterpret_cast<const int16_t *>(m_data);
+    }
+    return nullptr;
+}
+
+size_t WavFileAudioSource::GetChannelCount() const {
+    return m_channelCount;
+}
+
+size_t WavFileAudioSource::GetBitsPerSample() const {
+    return m_bitsPerSample;
+}
+
+bool WavFileAudioSource::IsFloat() const {
+    return m_float;
+}
+
+size_t WavFileAudioSource::frameSize() const {
+    return m_channelCount * m_bitsPerSample / 8;
+}
+
+} // namespace mace
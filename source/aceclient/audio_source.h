@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "aceclient.h"
+#include "audio.h"
+#include "mapped_file.h"
+#include "resampler.h"
+
+namespace mace {
+
+// The number of samples read at once when a source is consumed block by block.
+const size_t AUDIO_SOURCE_BLOCK_SIZE = 1 << 16;
+
+// Mono int16 audio that is read block by block, so a request never needs the whole clip in
+// memory as samples.
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    virtual size_t GetSampleRate() const = 0;
+    virtual size_t GetSampleCount() const = 0;
+    // Copies up to count samples from the sample index first into out, and returns the number
+    // of samples copied; 0 at the end of the audio.
+    virtual size_t Read(size_t first, int16_t *out, size_t count) const = 0;
+    // The samples when the source holds all of them contiguously as they are read, otherwise nullptr.
+    virtual const int16_t *GetSamples() const { return nullptr; }
+    // Identifies the samples, reading them one block at a time. Sources derived from another one
+    // may hash how they are derived instead, so their hash only matches the same derivation.
+    virtual uint64_t GetContentHash() const;
+};
+
+// Samples in memory at DefaultSampleRate, either borrowed from the caller or owned.
+class MemoryAudioSource : public AudioSource {
+public:
+    // The samples must outlive the source.
+    MemoryAudioSource(const int16_t *samples, size_t sample_count, size_t sample_rate = DefaultSampleRate);
+    explicit MemoryAudioSource(std::vector<int16_t> &&samples, size_t sample_rate = DefaultSampleRate);
+    MemoryAudioSource(MemoryAudioSource const &) = delete;
+    MemoryAudioSource &operator=(MemoryAudioSource const &) = delete;
+
+    size_t GetSampleRate() const override;
+    size_t GetSampleCount() const override;
+    size_t Read(size_t first, int16_t *out, size_t count) const override;
+    const int16_t *GetSamples() const override;
+
+protected:
+    std::vector<int16_t> m_owned;
+    const int16_t *m_samples;
+    size_t m_sampleCount;
+    size_t m_sampleRate;
+};
+
+// A range of the samples of another source, which must outlive it.
+class AudioSourceRange : public AudioSource {
+public:
+    AudioSourceRange(AudioSource const &source, size_t first, size_t count);
+
+    size_t GetSampleRate() const override;
+    size_t GetSampleCount() const override;
+    size_t Read(size_t first, int16_t *out, size_t count) const override;
+    const int16_t *GetSamples() const override;
+
+protected:
+    AudioSource const &m_source;
+    size_t m_first;
+    size_t m_count;
+};
+
+// Another source at a different sample rate, resampled block by block as it is read.
+class ResampledAudioSource : public AudioSource {
+public:
+    ResampledAudioSource(std::shared_ptr<const AudioSource> source, size_t sample_rate = DefaultSampleRate);
+
+    size_t GetSampleRate() const override;
+    size_t GetSampleCount() const override;
+    size_t Read(size_t first, int16_t *out, size_t count) const override;
+    // The hash of the source, the rates and the resampler, so the audio is not resampled just to
+    // be hashed.
+    uint64_t GetContentHash() const override;
+
+protected:
+    std::shared_ptr<const AudioSource> m_source;
+    PolyphaseResampler m_resampler;
+    size_t m_sampleCount;
+
+    // reused by Read, which may be called from several threads
+    mutable std::mutex m_scratchMutex;
+    mutable std::vector<int16_t> m_scratchSamples;
+    mutable std::vector<float> m_scratchInput;
+    mutable std::vector<float> m_scratchOutput;
+};
+
+// One channel of a memory-mapped WAV file, converted to int16 as it is read.
+// Reads 8, 16, 24 and 32 bits PCM and 32 and 64 bits IEEE float. Samples are not resampled;
+// 16 bits mono files are read without conversion.
+class WavFileAudioSource : public AudioSource {
+public:
+    WavFileAudioSource() = default;
+
+    // ERROR_INVALID_INPUT for missing files, unsupported formats and channels out of range.
+    AceClientStatus Open(std::string const &path, size_t channel = 0);
+    void Close();
+    bool IsOpen() const;
+
+    size_t GetSampleRate() const override;
+    size_t GetSampleCount() const override;
+    size_t Read(size_t first, int16_t *out, size_t count) const override;
+    const int16_t *GetSamples() const override;
+
+    size_t GetChannelCount() const;
+    size_t GetBitsPerSample() const;
+    bool IsFloat() const;
+
+protected:
+    MappedFile m_file;
+    const char *m_data = nullptr;
+    size_t m_sampleCount = 0;
+    size_t m_sampleRate = 0;
+    size_t m_channelCount = 0;
+    size_t m_bitsPerSample = 0;
+    bool m_float = false;
+    size_t m_channel = 0;
+
+    // the bytes between two samples of the channel
+    size_t frameSize() const;
+};
+
+} // namespace mace
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "channel_pool.h"
+#include "logger.h"
+
+using grpc::health::v1::Health;
+using nvidia_ace::services::a2f_controller::v1::A2FControllerService;
+
+namespace mace {
+
+std::shared_ptr<grpc::Channel> CreateChannel(std::string const &address, bool secured) {
+    if (secured) {
+        grpc::SslCredentialsOptions ssl_opts;
+        auto creds = grpc::SslCredentials(ssl_opts);
+        return grpc::CreateChannel(address, creds);
+    }
+    return grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+}
+
+ChannelPool &ChannelPool::Instance() {
+    static ChannelPool pool;
+    return pool;
+}
+
+std::shared_ptr<const PooledConnection> ChannelPool::Acquire(std::string const &address, bool secured) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto now = std::chrono::steady_clock::now();
+    auto key = std::make_pair(address, secured);
+    auto iter = m_entries.find(key);
+    if (iter != m_entries.end()) {
+        m_stats.hits++;
+        iter->second.lastAcquired = now;
+        expire(now);
+        return iter->second.connection;
+    }
+
+    m_stats.misses++;
+    LOG_DEBUG("ChannelPool: Creating a channel to " << address << " (secured: " << secured << ")");
+    auto connection = std::make_shared<PooledConnection>();
+    connection->channel = CreateChannel(address, secured);
+    connection->healthStub = Health::NewStub(connection->channel);
+    connection->a2fStub = A2FControllerService::NewStub(connection->channel);
+    m_entries[key] = Entry{connection, now};
+    expire(now);
+    return connection;
+}
+
+bool ChannelPool::Invalidate(std::string const &address, bool secured) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.erase(std::make_pair(address, secured)) == 0) {
+        return false;
+    }
+    m_stats.invalidations++;
+    LOG_DEBUG("ChannelPool: Invalidated the channel to " << address << " (secured: " << secured << ")");
+    return true;
+}
+
+void ChannelPool::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.invalidations += m_entries.size();
+    m_entries.clear();
+}
+
+void ChannelPool::SetIdleTTL(long long milliseconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_idleTTL = milliseconds;
+}
+
+long long ChannelPool::GetIdleTTL() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_idleTTL;
+}
+
+void ChannelPool::expire(std::chrono::steady_clock::time_point now) {
+    for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+        bool held = iter->second.connection.use_count() > 1;
+        // strictly older, so the entry acquired now always stays
+        if (!held && now - iter->second.lastAcquired > std::chrono::milliseconds(m_idleTTL)) {
+            LOG_DEBUG("ChannelPool: Dropped the idle channel to " << iter->first.first);
+            iter = m_entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+ChannelPoolStats ChannelPool::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ChannelPoolStats stats = m_stats;
+    stats.entries = m_entries.size();
+    return stats;
+}
+
+void ChannelPool::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = ChannelPoolStats();
+}
+
+} // namespace mace
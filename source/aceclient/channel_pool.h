@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/channel.h>
+#include "ace_grpc_cpp/health.grpc.pb.h"
+#include "ace_grpc_cpp/nvidia_ace.services.a2f_controller.v1.grpc.pb.h"
+
+namespace mace {
+
+std::shared_ptr<grpc::Channel> CreateChannel(std::string const &address, bool secured);
+
+const long long DEFAULT_CHANNEL_IDLE_TTL_MS = 5 * 60 * 1000;
+
+struct ChannelPoolStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t invalidations = 0;
+    size_t entries = 0;
+};
+
+// A gRPC channel with the stubs built on top of it.
+struct PooledConnection {
+    std::shared_ptr<grpc::Channel> channel;
+    std::shared_ptr<grpc::health::v1::Health::StubInterface> healthStub;
+    std::shared_ptr<nvidia_ace::services::a2f_controller::v1::A2FControllerService::StubInterface> a2fStub;
+};
+
+// Process-wide pool of channels and stubs keyed by (network address, TLS mode).
+// Every AnimationClient shares it, so repeated requests reuse an established HTTP/2
+// connection instead of paying DNS, TCP and TLS setup each time.
+// Connections already handed out stay valid after their entry is invalidated.
+// Settings of one client never drop a shared entry; entries go on connection errors, or when
+// nobody holds them and they have not been acquired for the idle TTL.
+class ChannelPool {
+public:
+    static ChannelPool &Instance();
+
+    std::shared_ptr<const PooledConnection> Acquire(std::string const &address, bool secured);
+    bool Invalidate(std::string const &address, bool secured);
+    void Clear();
+
+    void SetIdleTTL(long long milliseconds);
+    long long GetIdleTTL();
+
+    ChannelPoolStats GetStats();
+    void ResetStats();
+
+protected:
+    ChannelPool() = default;
+
+    struct Entry {
+        std::shared_ptr<const PooledConnection> connection;
+        std::chrono::steady_clock::time_point lastAcquired;
+    };
+
+    std::mutex m_mutex;
+    std::map<std::pair<std::string, bool>, Entry> m_entries;
+    long long m_idleTTL = DEFAULT_CHANNEL_IDLE_TTL_MS;
+    ChannelPoolStats m_stats;
+
+    // Drops the entries that are idle and not held outside of the pool; m_mutex must be held.
+    void expire(std::chrono::steady_clock::time_point now);
+};
+
+} // namespace mace
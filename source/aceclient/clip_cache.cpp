@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "clip_cache.h"
+#include "logger.h"
+
+namespace mace {
+
+ClipCache &ClipCache::Instance() {
+    static ClipCache cache;
+    return cache;
+}
+
+std::shared_ptr<const AnimationTrack> ClipCache::Get(RequestKey const &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter == m_index.end()) {
+        m_stats.misses++;
+        return nullptr;
+    }
+    m_stats.hits++;
+    m_entries.splice(m_entries.begin(), m_entries, iter->second);
+    return iter->second->track;
+}
+
+void ClipCache::Put(RequestKey const &key, std::shared_ptr<const AnimationTrack> track) {
+    if (!track) {
+        return;
+    }
+    size_t bytes = track->GetMemoryUsage();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter != m_index.end()) {
+        m_bytes -= iter->second->bytes;
+        m_entries.erase(iter->second);
+        m_index.erase(iter);
+    }
+    if (bytes > m_budget) {
+        LOG_DEBUG("ClipCache: A track of " << bytes << " bytes exceeds the budget");
+        return;
+    }
+    m_entries.push_front(Entry{key, std::move(track), bytes});
+    m_index[key] = m_entries.begin();
+    m_bytes += bytes;
+    m_stats.insertions++;
+    evict();
+}
+
+bool ClipCache::Remove(RequestKey const &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter == m_index.end()) {
+        return false;
+    }
+    m_bytes -= iter->second->bytes;
+    m_entries.erase(iter->second);
+    m_index.erase(iter);
+    return true;
+}
+
+void ClipCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+void ClipCache::SetBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    evict();
+}
+
+size_t ClipCache::GetBudget() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+ClipCacheStats ClipCache::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ClipCacheStats stats = m_stats;
+    stats.clips = m_entries.size();
+    stats.bytes = m_bytes;
+    return stats;
+}
+
+void ClipCache::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = ClipCacheStats();
+}
+
+void ClipCache::evict() {
+    while (m_bytes > m_budget && !m_entries.empty()) {
+        Entry const &entry = m_entries.back();
+        m_bytes -= entry.bytes;
+        m_index.erase(entry.key);
+        m_entries.pop_back();
+        m_stats.evictions++;
+    }
+}
+
+} // namespace mace
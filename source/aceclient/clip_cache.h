@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "animation_track.h"
+#include "hash.h"
+
+namespace mace {
+
+const size_t DEFAULT_CLIP_CACHE_BUDGET = 256 << 20;
+
+struct ClipCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t insertions = 0;
+    size_t evictions = 0;
+    // current contents
+    size_t clips = 0;
+    size_t bytes = 0;
+};
+
+// Process-wide cache of received tracks keyed by their request, shared by every AnimationClient.
+// Tracks are immutable once cached; clients holding one keep it alive after it is evicted.
+// The least recently used tracks are evicted when the total of their memory usage exceeds the
+// budget, and a track larger than the budget is not cached.
+class ClipCache {
+public:
+    static ClipCache &Instance();
+
+    std::shared_ptr<const AnimationTrack> Get(RequestKey const &key);
+    void Put(RequestKey const &key, std::shared_ptr<const AnimationTrack> track);
+    bool Remove(RequestKey const &key);
+    void Clear();
+
+    void SetBudget(size_t bytes);
+    size_t GetBudget();
+
+    ClipCacheStats GetStats();
+    void ResetStats();
+
+protected:
+    ClipCache() = default;
+
+    struct Entry {
+        RequestKey key;
+        std::shared_ptr<const AnimationTrack> track;
+        size_t bytes;
+    };
+
+    std::mutex m_mutex;
+    // the most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<RequestKey, std::list<Entry>::iterator, RequestKeyHash> m_index;
+    size_t m_bytes = 0;
+    size_t m_budget = DEFAULT_CLIP_CACHE_BUDGET;
+    ClipCacheStats m_stats;
+
+    // Evicts until the budget is met; m_mutex must be held.
+    void evict();
+};
+
+} // namespace mace
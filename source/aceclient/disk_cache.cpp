@@ -0,0 +1,220 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "disk_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "logger.h"
+#include "mapped_file.h"
+
+namespace fs = std::filesystem;
+
+namespace mace {
+
+namespace {
+
+const char CLIP_EXTENSION[] = ".clip";
+
+// A name no other thread or process writes to at the same time.
+std::string temporaryName(RequestKey const &key) {
+    static std::atomic<uint64_t> counter(0);
+    static const uint64_t processSalt = std::random_device()();
+    uint64_t unique = processSalt ^ (std::hash<std::thread::id>()(std::this_thread::get_id()) << 16) ^
+        static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    return key.ToString() + "." + std::to_string(unique) + "." + std::to_string(counter++) + ".tmp";
+}
+
+}
+
+DiskCache::DiskCache(std::string const &directory, uint64_t maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes) {}
+
+std::string const &DiskCache::GetDirectory() const {
+    return m_directory;
+}
+
+void DiskCache::SetMaxBytes(uint64_t maxBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBytes = maxBytes;
+}
+
+uint64_t DiskCache::GetMaxBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxBytes;
+}
+
+std::string DiskCache::GetPath(RequestKey const &key) const {
+    return (fs::u8path(m_directory) / (key.ToString() + CLIP_EXTENSION)).u8string();
+}
+
+bool DiskCache::Load(RequestKey const &key, AnimationTrack *track) {
+    std::string path = GetPath(key);
+    bool loaded = false;
+    {
+        MappedFile file;
+        if (file.Open(path)) {
+            loaded = track->ReadClip(file.GetData(), file.GetSize());
+            if (!loaded) {
+                LOG_ERROR("DiskCache: Invalid clip " << path);
+            }
+        }
+    }
+
+    std::error_code error;
+    if (loaded) {
+        // the modification time orders the clips for eviction
+        fs::last_write_time(fs::u8path(path), fs::file_time_type::clock::now(), error);
+    }
+    else if (fs::exists(fs::u8path(path), error)) {
+        fs::remove(fs::u8path(path), error);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (loaded) {
+        m_stats.hits++;
+    }
+    else {
+        m_stats.misses++;
+    }
+    return loaded;
+}
+
+bool DiskCache::Store(RequestKey const &key, AnimationTrack const &track) {
+    std::error_code error;
+    fs::path directory = fs::u8path(m_directory);
+    fs::create_directories(directory, error);
+    fs::path temporary = directory / temporaryName(key);
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out || !track.WriteClip(out)) {
+            LOG_ERROR("DiskCache: Cannot write " << temporary.u8string());
+            out.close();
+            fs::remove(temporary, error);
+            return false;
+        }
+    }
+    // the clip appears complete or not at all
+    fs::rename(temporary, fs::u8path(GetPath(key)), error);
+    if (error) {
+        LOG_ERROR("DiskCache: Cannot store " << GetPath(key) << ": " << error.message());
+        fs::remove(temporary, error);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.stores++;
+    }
+    Trim();
+    return true;
+}
+
+bool DiskCache::Remove(RequestKey const &key) {
+    std::error_code error;
+    return fs::remove(fs::u8path(GetPath(key)), error);
+}
+
+size_t DiskCache::Trim() {
+    uint64_t maxBytes = GetMaxBytes();
+    std::error_code error;
+    std::vector<std::tuple<fs::file_time_type, uint64_t, fs::path>> clips;
+    uint64_t total = 0;
+    for (auto const &entry : fs::directory_iterator(fs::u8path(m_directory), error)) {
+        if (entry.path().extension() != CLIP_EXTENSION) {
+            continue;
+        }
+        std::error_code entryError;
+        uint64_t size = entry.file_size(entryError);
+        fs::file_time_type time = entry.last_write_time(entryError);
+        if (entryError) {
+            // removed by another process meanwhile
+            continue;
+        }
+        clips.emplace_back(time, size, entry.path());
+        total += size;
+    }
+    if (total <= maxBytes) {
+        return 0;
+    }
+
+    std::sort(clips.begin(), clips.end());
+    size_t evicted = 0;
+    for (auto const &[time, size, path] : clips) {
+        if (total <= maxBytes) {
+            break;
+        }
+        // a clip mapped by another process may not be removable yet on Windows
+        if (fs::remove(path, error)) {
+            total -= size;
+            evicted++;
+        }
+    }
+    LOG_DEBUG("DiskCache: Evicted " << evicted << " clips from " << m_directory);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.evictions += evicted;
+    return evicted;
+}
+
+uint64_t DiskCache::GetSize() const {
+    std::error_code error;
+    uint64_t total = 0;
+    for (auto const &entry : fs::directory_iterator(fs::u8path(m_directory), error)) {
+        std::error_code entryError;
+        if (entry.path().extension() == CLIP_EXTENSION) {
+            uint64_t size = entry.file_size(entryError);
+            total += entryError ? 0 : size;
+        }
+    }
+    return total;
+}
+
+void DiskCache::Clear() {
+    std::error_code error;
+    std::vector<fs::path> clips;
+    for (auto const &entry : fs::directory_iterator(fs::u8path(m_directory), error)) {
+        if (entry.path().extension() == CLIP_EXTENSION) {
+            clips.push_back(entry.path());
+        }
+    }
+    for (auto const &path : clips) {
+        fs::remove(path, error);
+    }
+}
+
+DiskCacheStats DiskCache::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void DiskCache::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = DiskCacheStats();
+}
+
+} // namespace mace
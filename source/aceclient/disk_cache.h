@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "animation_track.h"
+#include "hash.h"
+
+namespace mace {
+
+const uint64_t DEFAULT_DISK_CACHE_SIZE = 1ULL << 30;
+
+struct DiskCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t stores = 0;
+    size_t evictions = 0;
+};
+
+// Received animation kept as clip files in a directory, named by the key of their request.
+// Several processes may share a directory: clips are written to a temporary file and renamed
+// into place, and a reader maps a clip in full, so it never sees a partial one. Loading a clip
+// marks it as recently used, and storing one evicts the least recently used clips beyond the
+// size limit.
+class DiskCache {
+public:
+    explicit DiskCache(std::string const &directory, uint64_t maxBytes = DEFAULT_DISK_CACHE_SIZE);
+
+    std::string const &GetDirectory() const;
+    void SetMaxBytes(uint64_t maxBytes);
+    uint64_t GetMaxBytes();
+    std::string GetPath(RequestKey const &key) const;
+
+    // Replaces the track with the cached clip; false on a miss.
+    bool Load(RequestKey const &key, AnimationTrack *track);
+    bool Store(RequestKey const &key, AnimationTrack const &track);
+    bool Remove(RequestKey const &key);
+    // Evicts the least recently used clips until the total size is within the limit, and returns
+    // the number of evicted clips.
+    size_t Trim();
+    // the total size of the clips
+    uint64_t GetSize() const;
+    void Clear();
+
+    DiskCacheStats GetStats();
+    void ResetStats();
+
+protected:
+    std::string m_directory;
+    std::mutex m_mutex;
+    uint64_t m_maxBytes;
+    DiskCacheStats m_stats;
+};
+
+} // namespace mace
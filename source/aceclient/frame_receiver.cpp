@@ -20,4 +20,102 @@
 // SOFTWARE.
 #include "frame_receiver.h"
 
-AnimDataFrame::AnimDataFrame() {}
+#include <algorithm>
+#include <utility>
+
+AnimDataFrame::AnimDataFrame() : timestamp(0.0) {}
+
+namespace mace {
+
+FrameCollector::FrameCollector(std::vector<AnimDataFrame> *frames) : m_frames(frames) {}
+
+void FrameCollector::OnHeader(
+    std::vector<std::string> const &blend_shape_names,
+    std::vector<std::string> const &emotion_state_names) {
+    m_blendshapeNames = blend_shape_names;
+    m_emotionStateNames = emotion_state_names;
+}
+
+void FrameCollector::OnFrames(std::vector<AnimDataFrame> &&frames) {
+    for (auto &frame : frames) {
+        if (frame.blend_shape_names.empty()) {
+            frame.blend_shape_names = m_blendshapeNames;
+        }
+        if (frame.emotion_state_names.empty()) {
+            frame.emotion_state_names = m_emotionStateNames;
+        }
+        m_frames->push_back(std::move(frame));
+    }
+}
+
+// Resumed audio starts on a sample boundary, so its frames may be off by a fraction of a sample.
+const double SPLICE_TOLERANCE_SEC = 1e-3;
+
+FrameSplicer::FrameSplicer(FrameReceiver *receiver) : m_receiver(receiver) {}
+
+void FrameSplicer::SetTimeOffset(double seconds) {
+    m_timeOffset = seconds;
+}
+
+bool FrameSplicer::HasFrames() const {
+    return !m_timestamps.empty();
+}
+
+double FrameSplicer::GetResumeTime(double preroll) const {
+    if (m_timestamps.empty()) {
+        return 0.0;
+    }
+    auto iter = std::lower_bound(m_timestamps.begin(), m_timestamps.end(), m_timestamps.back() - preroll);
+    return *iter;
+}
+
+void FrameSplicer::OnHeader(
+    std::vector<std::string> const &blend_shape_names,
+    std::vector<std::string> const &emotion_state_names) {
+    if (!m_hasHeader) {
+        m_hasHeader = true;
+        m_receiver->OnHeader(blend_shape_names, emotion_state_names);
+    }
+}
+
+void FrameSplicer::OnFrames(std::vector<AnimDataFrame> &&frames) {
+    std::vector<AnimDataFrame> newFrames;
+    newFrames.reserve(frames.size());
+    for (auto &frame : frames) {
+        frame.timestamp += m_timeOffset;
+        if (!m_timestamps.empty() && frame.timestamp <= m_timestamps.back() + SPLICE_TOLERANCE_SEC) {
+            // already forwarded by a previous attempt
+            continue;
+        }
+        m_timestamps.push_back(frame.timestamp);
+        newFrames.push_back(std::move(frame));
+    }
+    if (!newFrames.empty()) {
+        m_receiver->OnFrames(std::move(newFrames));
+    }
+}
+
+void FrameSplicer::OnStatus(int code, std::string const &message) {
+    m_receiver->OnStatus(code, message);
+}
+
+FrameTee::FrameTee(FrameReceiver *first, FrameReceiver *second) : m_first(first), m_second(second) {}
+
+void FrameTee::OnHeader(
+    std::vector<std::string> const &blend_shape_names,
+    std::vector<std::string> const &emotion_state_names) {
+    m_first->OnHeader(blend_shape_names, emotion_state_names);
+    m_second->OnHeader(blend_shape_names, emotion_state_names);
+}
+
+void FrameTee::OnFrames(std::vector<AnimDataFrame> &&frames) {
+    m_first->OnFrames(std::vector<AnimDataFrame>(frames));
+    m_second->OnFrames(std::move(frames));
+}
+
+void FrameTee::OnStatus(int code, std::string const &message) {
+    m_first->OnStatus(code, message);
+    m_second->OnStatus(code, message);
+}
+
+} // namespace mace
@@ -38,3 +38,85 @@ public:
     std::vector<float> audio_samples;
     double timestamp;
 };
+
+namespace mace {
+
+// Receives the animation of a request incrementally, while the response stream is being read.
+// All callbacks are invoked on the thread that reads the stream.
+class FrameReceiver {
+public:
+    virtual ~FrameReceiver() = default;
+
+    // The names of the channels; called once before any frame.
+    virtual void OnHeader(
+        std::vector<std::string> const &blend_shape_names,
+        std::vector<std::string> const &emotion_state_names) {}
+    // A batch of decoded frames in stream order. Receivers may move the frames out.
+    // The names are only given to OnHeader; the frames do not repeat them.
+    virtual void OnFrames(std::vector<AnimDataFrame> &&frames) = 0;
+    // INFO, WARNING and ERROR status messages from the server.
+    virtual void OnStatus(int code, std::string const &message) {}
+    // The end of the request, whether it succeeded or not; called exactly once.
+    virtual void OnComplete(AceClientStatus status) {}
+};
+
+// Collects all received frames into a vector, with the names of the header in every frame.
+class FrameCollector : public FrameReceiver {
+public:
+    explicit FrameCollector(std::vector<AnimDataFrame> *frames);
+
+    void OnHeader(
+        std::vector<std::string> const &blend_shape_names,
+        std::vector<std::string> const &emotion_state_names) override;
+    void OnFrames(std::vector<AnimDataFrame> &&frames) override;
+
+protected:
+    std::vector<AnimDataFrame> *m_frames;
+    std::vector<std::string> m_blendshapeNames;
+    std::vector<std::string> m_emotionStateNames;
+};
+
+// Joins the attempts of a resumed request into one stream of frames.
+// The frames of an attempt are shifted by the time offset of the audio it was sent, frames that
+// were already forwarded are dropped, and only the first header is forwarded.
+// OnComplete is not forwarded; the owner completes the receiver once all attempts are done.
+class FrameSplicer : public FrameReceiver {
+public:
+    explicit FrameSplicer(FrameReceiver *receiver);
+
+    void SetTimeOffset(double seconds);
+    bool HasFrames() const;
+    // The earliest forwarded timestamp within preroll seconds before the last one.
+    double GetResumeTime(double preroll) const;
+
+    void OnHeader(
+        std::vector<std::string> const &blend_shape_names,
+        std::vector<std::string> const &emotion_state_names) override;
+    void OnFrames(std::vector<AnimDataFrame> &&frames) override;
+    void OnStatus(int code, std::string const &message) override;
+
+protected:
+    FrameReceiver *m_receiver;
+    double m_timeOffset = 0.0;
+    bool m_hasHeader = false;
+    std::vector<double> m_timestamps;
+};
+
+// Forwards everything to two receivers, e.g. to keep a copy of the frames while they are delivered.
+// The first receiver is given copies of the frames. OnComplete is not forwarded.
+class FrameTee : public FrameReceiver {
+public:
+    FrameTee(FrameReceiver *first, FrameReceiver *second);
+
+    void OnHeader(
+        std::vector<std::string> const &blend_shape_names,
+        std::vector<std::string> const &emotion_state_names) override;
+    void OnFrames(std::vector<AnimDataFrame> &&frames) override;
+    void OnStatus(int code, std::string const &message) override;
+
+protected:
+    FrameReceiver *m_first;
+    FrameReceiver *m_second;
+};
+
+} // namespace mace
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "hash.h"
+
+#include <cstring>
+
+namespace mace {
+
+uint64_t Hash64(const void *data, size_t size, uint64_t seed) {
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    uint64_t h = seed ^ (size * m);
+
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    const unsigned char *end = bytes + (size / 8) * 8;
+    for (; bytes != end; bytes += 8) {
+        uint64_t k;
+        std::memcpy(&k, bytes, sizeof(k));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (size & 7) {
+    case 7: h ^= uint64_t(bytes[6]) << 48; [[fallthrough]];
+    case 6: h ^= uint64_t(bytes[5]) << 40; [[fallthrough]];
+    case 5: h ^= uint64_t(bytes[4]) << 32; [[fallthrough]];
+    case 4: h ^= uint64_t(bytes[3]) << 24; [[fallthrough]];
+    case 3: h ^= uint64_t(bytes[2]) << 16; [[fallthrough]];
+    case 2: h ^= uint64_t(bytes[1]) << 8; [[fallthrough]];
+    case 1: h ^= uint64_t(bytes[0]);
+        h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+std::string RequestKey::ToString() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        text[15 - i] = digits[(audio >> (4 * i)) & 0xf];
+        text[31 - i] = digits[(parameters >> (4 * i)) & 0xf];
+    }
+    return text;
+}
+
+} // namespace mace
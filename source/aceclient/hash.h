@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace mace {
+
+// A fast, non-cryptographic 64-bit hash (MurmurHash64A). Stable across runs, so it can name files.
+uint64_t Hash64(const void *data, size_t size, uint64_t seed = 0);
+
+// Bumped when what goes into a RequestKey changes, so that clips cached on disk by an older build
+// miss instead of being returned for a different request.
+const uint32_t REQUEST_KEY_VERSION = 1;
+
+// Identifies the result of a request: the hash of the audio and the hash of everything else that
+// changes the animation, i.e. the serialized parameters, the function ID and the emotion state.
+struct RequestKey {
+    uint64_t audio = 0;
+    uint64_t parameters = 0;
+
+    // 32 hex digits, usable as a file name
+    std::string ToString() const;
+
+    bool operator==(RequestKey const &other) const {
+        return audio == other.audio && parameters == other.parameters;
+    }
+    bool operator!=(RequestKey const &other) const {
+        return !(*this == other);
+    }
+};
+
+struct RequestKeyHash {
+    size_t operator()(RequestKey const &key) const {
+        return static_cast<size_t>(key.audio ^ (key.parameters * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+} // namespace mace
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "health_cache.h"
+#include "logger.h"
+
+namespace mace {
+
+HealthCache &HealthCache::Instance() {
+    static HealthCache cache;
+    return cache;
+}
+
+bool HealthCache::IsHealthy(std::string const &address, bool secured, std::string const &apiKey,
+    std::string const &functionId, long long ttlMilliseconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_entries.find(Key(address, secured, apiKey, functionId));
+    if (iter != m_entries.end() &&
+        std::chrono::steady_clock::now() - iter->second < std::chrono::milliseconds(ttlMilliseconds)) {
+        m_stats.hits++;
+        return true;
+    }
+    m_stats.misses++;
+    return false;
+}
+
+void HealthCache::MarkHealthy(std::string const &address, bool secured, std::string const &apiKey,
+    std::string const &functionId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[Key(address, secured, apiKey, functionId)] = std::chrono::steady_clock::now();
+}
+
+bool HealthCache::Invalidate(std::string const &address, bool secured, std::string const &apiKey,
+    std::string const &functionId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.erase(Key(address, secured, apiKey, functionId)) == 0) {
+        return false;
+    }
+    m_stats.invalidations++;
+    LOG_DEBUG("HealthCache: Invalidated the health of " << address << " (secured: " << secured << ")");
+    return true;
+}
+
+void HealthCache::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.invalidations += m_entries.size();
+    m_entries.clear();
+}
+
+HealthCacheStats HealthCache::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void HealthCache::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = HealthCacheStats();
+}
+
+} // namespace mace
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace mace {
+
+// How AnimationClient checks the server before streaming audio.
+enum HealthCheckMode {
+    // check before every request
+    HealthCheckAlways,
+    // reuse a successful check until it expires
+    HealthCheckCached,
+    // never check; failures surface from the audio stream itself
+    HealthCheckSkip,
+};
+
+const long long DEFAULT_HEALTH_CHECK_TTL_MS = 30000;
+
+struct HealthCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t invalidations = 0;
+};
+
+// Process-wide record of successful health checks keyed by (network address, TLS mode, apiKey, functionId).
+// Only successes are cached; a failed check or a failed request drops the entry.
+class HealthCache {
+public:
+    static HealthCache &Instance();
+
+    bool IsHealthy(std::string const &address, bool secured, std::string const &apiKey,
+        std::string const &functionId, long long ttlMilliseconds);
+    void MarkHealthy(std::string const &address, bool secured, std::string const &apiKey,
+        std::string const &functionId);
+    bool Invalidate(std::string const &address, bool secured, std::string const &apiKey,
+        std::string const &functionId);
+    void Clear();
+
+    HealthCacheStats GetStats();
+    void ResetStats();
+
+protected:
+    HealthCache() = default;
+
+    typedef std::tuple<std::string, bool, std::string, std::string> Key;
+
+    std::mutex m_mutex;
+    std::map<Key, std::chrono::steady_clock::time_point> m_entries;
+    HealthCacheStats m_stats;
+};
+
+} // namespace mace
@@ -36,6 +36,7 @@ project "aceclient"
         absl_include_path,
         grpc_include_path,
         protobuf_include_path,
+        zlib_include_path,
         source_path,
         "."
     }
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "request_coalescer.h"
+
+namespace mace {
+
+RequestCoalescer &RequestCoalescer::Instance() {
+    static RequestCoalescer coalescer;
+    return coalescer;
+}
+
+bool RequestCoalescer::Join(RequestKey const &key, std::shared_future<CoalescedResult> *result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_requests.find(key);
+    if (iter != m_requests.end()) {
+        m_stats.followers++;
+        *result = iter->second->result;
+        return false;
+    }
+    auto request = std::make_shared<InFlight>();
+    request->result = request->promise.get_future().share();
+    m_requests[key] = request;
+    *result = request->result;
+    m_stats.leaders++;
+    return true;
+}
+
+void RequestCoalescer::Complete(RequestKey const &key, CoalescedResult const &result) {
+    std::shared_ptr<InFlight> request;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto iter = m_requests.find(key);
+        if (iter == m_requests.end()) {
+            return;
+        }
+        request = iter->second;
+        m_requests.erase(iter);
+    }
+    // later requests of the key start a new one; the waiters are woken outside of the lock
+    request->promise.set_value(result);
+}
+
+RequestCoalescerStats RequestCoalescer::GetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RequestCoalescerStats stats = m_stats;
+    stats.inFlight = m_requests.size();
+    return stats;
+}
+
+void RequestCoalescer::ResetStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats = RequestCoalescerStats();
+}
+
+} // namespace mace
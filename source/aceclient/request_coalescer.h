@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "aceclient.h"
+#include "animation_track.h"
+#include "hash.h"
+
+namespace mace {
+
+// The outcome of a request shared with every caller that joined it.
+struct CoalescedResult {
+    AceClientStatus status = AceClientStatus::ERROR_UNKNOWN;
+    // the received frames; empty unless the request succeeded
+    std::shared_ptr<const AnimationTrack> track;
+};
+
+struct RequestCoalescerStats {
+    // requests that went to the server
+    size_t leaders = 0;
+    // requests that waited for an identical one instead
+    size_t followers = 0;
+    // current contents
+    size_t inFlight = 0;
+};
+
+// Process-wide registry of requests in flight keyed by their request.
+// The first caller of a key becomes the leader and runs the request; identical requests made
+// before it completes wait for its result instead of going to the server.
+class RequestCoalescer {
+public:
+    static RequestCoalescer &Instance();
+
+    // Returns true when the caller leads the request and must Complete() it. Otherwise the
+    // result of the request in flight is delivered through the future.
+    bool Join(RequestKey const &key, std::shared_future<CoalescedResult> *result);
+    void Complete(RequestKey const &key, CoalescedResult const &result);
+
+    RequestCoalescerStats GetStats();
+    void ResetStats();
+
+protected:
+    RequestCoalescer() = default;
+
+    struct InFlight {
+        std::promise<CoalescedResult> promise;
+        std::shared_future<CoalescedResult> result;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<RequestKey, std::shared_ptr<InFlight>, RequestKeyHash> m_requests;
+    RequestCoalescerStats m_stats;
+};
+
+} // namespace mace
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "request_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "logger.h"
+
+namespace mace {
+
+RequestScheduler::RequestScheduler(size_t maxConcurrency) {
+    SetMaxConcurrency(maxConcurrency);
+    // identical jobs, in this batch or in flight elsewhere, share one stream
+    m_client.SetCoalesceRequests(true);
+}
+
+AceClientStatus RequestScheduler::SetUrl(std::string const &newUrl) {
+    return m_client.SetUrl(newUrl);
+}
+
+std::string const RequestScheduler::GetUrl() {
+    return m_client.GetUrl();
+}
+
+AceClientStatus RequestScheduler::SetAPIKey(std::string const &newApiKey) {
+    return m_client.SetAPIKey(newApiKey);
+}
+
+std::string const RequestScheduler::GetAPIKey() {
+    return m_client.GetAPIKey();
+}
+
+AceClientStatus RequestScheduler::SetFunctionId(std::string const &newFunctionId) {
+    return m_client.SetFunctionId(newFunctionId);
+}
+
+std::string const RequestScheduler::GetFunctionId() {
+    return m_client.GetFunctionId();
+}
+
+void RequestScheduler::SetMaxConcurrency(size_t maxConcurrency) {
+    m_maxConcurrency = std::max<size_t>(maxConcurrency, 1);
+}
+
+size_t RequestScheduler::GetMaxConcurrency() const {
+    return m_maxConcurrency;
+}
+
+std::vector<AnimationJobResult> RequestScheduler::Run(std::vector<AnimationJob> const &jobs) {
+    std::vector<AnimationJobResult> results(jobs.size());
+    if (jobs.empty()) {
+        return results;
+    }
+
+    // each worker keeps taking the next pending job, so a slow clip does not hold up the others
+    std::atomic<size_t> nextJob(0);
+    auto worker = [&]() {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            results[i] = runJob(jobs[i]);
+        }
+    };
+
+    size_t workerCount = std::min(m_maxConcurrency, jobs.size());
+    LOG_INFO("RequestScheduler: Running " << jobs.size() << " jobs on " << workerCount << " streams.");
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount - 1);
+    for (size_t i = 1; i < workerCount; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : workers) {
+        thread.join();
+    }
+    return results;
+}
+
+AnimationJobResult RequestScheduler::runJob(AnimationJob const &job) {
+    AnimationClient client(m_client);
+    client.SetFaceParameters(job.faceParameters);
+    client.SetEmotionParameters(job.emotionParameters);
+    client.SetEmotionState(job.emotionState);
+    for (auto const &[key, value] : job.blendshapeMultipliers) {
+        client.SetBlendshapeMultiplier(key, value);
+    }
+    for (auto const &[key, value] : job.blendshapeOffsets) {
+        client.SetBlendshapeOffset(key, value);
+    }
+
+    AnimationJobResult result;
+    result.status = client.RequestAnimation(job.samples, &result.frames);
+    if (result.status != AceClientStatus::OK) {
+        LOG_ERROR("RequestScheduler: Job failed: " << result.status);
+    }
+    return result;
+}
+
+} // namespace mace
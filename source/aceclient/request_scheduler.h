@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "aceclient.h"
+#include "animation.h"
+#include "frame_receiver.h"
+#include "parameters.h"
+
+namespace mace {
+
+const size_t DEFAULT_MAX_CONCURRENT_REQUESTS = 4;
+
+// One clip to animate: the audio and the parameters it is animated with.
+struct AnimationJob {
+    std::vector<int16_t> samples;
+    AceFaceParameters faceParameters;
+    AceEmotionParameters emotionParameters;
+    AceEmotionState emotionState;
+    std::map<std::string, float> blendshapeMultipliers;
+    std::map<std::string, float> blendshapeOffsets;
+};
+
+struct AnimationJobResult {
+    AceClientStatus status = AceClientStatus::ERROR_UNKNOWN;
+    std::vector<AnimDataFrame> frames;
+};
+
+// Runs a batch of animation requests concurrently.
+// All requests to the same endpoint share a pooled channel, so the streams are multiplexed
+// over one HTTP/2 connection; the number of streams in flight is bounded by the concurrency limit.
+class RequestScheduler {
+public:
+    explicit RequestScheduler(size_t maxConcurrency = DEFAULT_MAX_CONCURRENT_REQUESTS);
+    virtual ~RequestScheduler() = default;
+
+    AceClientStatus SetUrl(std::string const &newUrl);
+    std::string const GetUrl();
+    AceClientStatus SetAPIKey(std::string const &newApiKey);
+    std::string const GetAPIKey();
+    AceClientStatus SetFunctionId(std::string const &newFunctionId);
+    std::string const GetFunctionId();
+
+    void SetMaxConcurrency(size_t maxConcurrency);
+    size_t GetMaxConcurrency() const;
+
+    // Blocks until every job has finished. Results are in the order of the jobs.
+    std::vector<AnimationJobResult> Run(std::vector<AnimationJob> const &jobs);
+
+protected:
+    // only holds the connection settings; each job runs on its own copy
+    AnimationClient m_client;
+    size_t m_maxConcurrency;
+
+    virtual AnimationJobResult runJob(AnimationJob const &job);
+};
+
+} // namespace mace
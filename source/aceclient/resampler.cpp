@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "resampler.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    const double PI = 3.14159265358979323846;
+    // about 80dB of stopband attenuation
+    const double KAISER_BETA = 8.0;
+
+    // the zeroth order modified Bessel function of the first kind
+    double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 64 && term > sum * 1e-12; ++k) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    double sinc(double x) {
+        return x == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+    }
+}
+
+namespace mace {
+
+PolyphaseResampler::PolyphaseResampler(size_t sourceRate, size_t targetRate, size_t zeroCrossings)
+    : m_sourceRate(sourceRate), m_targetRate(targetRate) {
+    uint64_t divisor = std::gcd(static_cast<uint64_t>(std::max<size_t>(sourceRate, 1)),
+        static_cast<uint64_t>(std::max<size_t>(targetRate, 1)));
+    m_up = std::max<size_t>(targetRate, 1) / divisor;
+    m_down = std::max<size_t>(sourceRate, 1) / divisor;
+    m_phaseCount = static_cast<size_t>(std::min<uint64_t>(m_up, RESAMPLER_MAX_PHASES));
+
+    // the filter is scaled to the narrower band, so it spans more input samples when downsampling
+    double cutoff = RESAMPLER_CUTOFF * std::min(1.0, static_cast<double>(m_up) / m_down);
+    size_t halfLength = static_cast<size_t>(std::ceil(zeroCrossings / cutoff));
+    m_tapCount = 2 * halfLength;
+    m_filters.resize(m_phaseCount * m_tapCount);
+
+    double const windowScale = 1.0 / besselI0(KAISER_BETA);
+    for (size_t phase = 0; phase < m_phaseCount; ++phase) {
+        float *filter = &m_filters[phase * m_tapCount];
+        double fraction = static_cast<double>(phase) / m_phaseCount;
+        double sum = 0.0;
+        for (size_t tap = 0; tap < m_tapCount; ++tap) {
+            // the distance of the tap from the output position, in input samples
+            double x = static_cast<double>(tap) - (halfLength - 1) - fraction;
+            double r = x / halfLength;
+            double window = r * r < 1.0 ? besselI0(KAISER_BETA * std::sqrt(1.0 - r * r)) * windowScale : 0.0;
+            double weight = cutoff * sinc(cutoff * x) * window;
+            filter[tap] = static_cast<float>(weight);
+            sum += weight;
+        }
+        // unity gain at DC for every phase
+        for (size_t tap = 0; tap < m_tapCount; ++tap) {
+            filter[tap] = static_cast<float>(filter[tap] / sum);
+        }
+    }
+}
+
+size_t PolyphaseResampler::GetSourceRate() const {
+    return m_sourceRate;
+}
+
+size_t PolyphaseResampler::GetTargetRate() const {
+    return m_targetRate;
+}
+
+size_t PolyphaseResampler::GetPhaseCount() const {
+    return m_phaseCount;
+}
+
+size_t PolyphaseResampler::GetTapCount() const {
+    return m_tapCount;
+}
+
+size_t PolyphaseResampler::GetOutputCount(size_t inputCount) const {
+    return static_cast<size_t>((inputCount * m_up + m_down - 1) / m_down);
+}
+
+void PolyphaseResampler::GetInputRange(size_t firstOutput, size_t outputCount, int64_t *first, int64_t *last) const {
+    if (outputCount == 0) {
+        *first = *last = 0;
+        return;
+    }
+    size_t phase;
+    int64_t lastFirst;
+    locate(firstOutput, first, &phase);
+    locate(firstOutput + outputCount - 1, &lastFirst, &phase);
+    *last = lastFirst + static_cast<int64_t>(m_tapCount);
+}
+
+void PolyphaseResampler::Process(const float *input, int64_t inputFirst, size_t inputCount,
+    size_t firstOutput, size_t outputCount, float *out) const {
+    int64_t const inputLast = inputFirst + static_cast<int64_t>(inputCount);
+    // the taps of output samples at the ends of the input, padded with zeros
+    std::vector<float> window;
+    for (size_t i = 0; i < outputCount; ++i) {
+        int64_t first;
+        size_t phase;
+        locate(firstOutput + i, &first, &phase);
+        const float *filter = &m_filters[phase * m_tapCount];
+        int64_t const last = first + static_cast<int64_t>(m_tapCount);
+        if (first >= inputFirst && last <= inputLast) {
+            out[i] = Dot(input + (first - inputFirst), filter, m_tapCount);
+            continue;
+        }
+        window.assign(m_tapCount, 0.0f);
+        for (int64_t n = std::max(first, inputFirst); n < std::min(last, inputLast); ++n) {
+            window[n - first] = input[n - inputFirst];
+        }
+        out[i] = Dot(window.data(), filter, m_tapCount);
+    }
+}
+
+void PolyphaseResampler::locate(size_t output, int64_t *first, size_t *phase) const {
+    uint64_t position = static_cast<uint64_t>(output) * m_down;
+    uint64_t whole = position / m_up;
+    uint64_t fraction = position % m_up;
+    // the nearest phase when there are fewer phases than fractional positions
+    uint64_t index = (fraction * m_phaseCount + m_up / 2) / m_up;
+    if (index == m_phaseCount) {
+        index = 0;
+        whole++;
+    }
+    *phase = static_cast<size_t>(index);
+    *first = static_cast<int64_t>(whole) - static_cast<int64_t>(m_tapCount / 2 - 1);
+}
+
+} // namespace mace
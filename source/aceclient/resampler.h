@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mace {
+
+// sinc zero crossings on each side of the filter, at the rate of the narrower band
+const size_t RESAMPLER_ZERO_CROSSINGS = 24;
+// the passband edge as a fraction of the narrower Nyquist frequency
+const float RESAMPLER_CUTOFF = 0.9f;
+// rate ratios with more phases use the nearest of this many
+const size_t RESAMPLER_MAX_PHASES = 1024;
+// Bumped with any change to the output of the resampler, e.g. of its filter, since resampled
+// audio is identified by its source and rates rather than by its samples.
+const uint32_t RESAMPLER_VERSION = 1;
+
+// Converts the sample rate with a Kaiser-windowed sinc filter, low-passed at the lower of the two
+// Nyquist frequencies so downsampling does not alias.
+// The rates are reduced to up/down, and output sample k is at input position k * down / up. The
+// filter of each of the up fractional positions is precomputed, so an output sample is a single
+// dot product over the input around its position. Any range of the output can be computed from
+// the input around it, so long audio is converted block by block.
+class PolyphaseResampler {
+public:
+    PolyphaseResampler(size_t sourceRate, size_t targetRate, size_t zeroCrossings = RESAMPLER_ZERO_CROSSINGS);
+
+    size_t GetSourceRate() const;
+    size_t GetTargetRate() const;
+    size_t GetPhaseCount() const;
+    size_t GetTapCount() const;
+
+    // The number of output samples of the input, up to the position of its last sample.
+    size_t GetOutputCount(size_t inputCount) const;
+    // The input samples [first, last) read by the output samples [firstOutput, firstOutput + outputCount).
+    // The range extends beyond the audio at its ends, where the input is silence.
+    void GetInputRange(size_t firstOutput, size_t outputCount, int64_t *first, int64_t *last) const;
+    // Computes the output samples [firstOutput, firstOutput + outputCount) into out. input holds
+    // the input samples from inputFirst on; samples outside of it are read as zeros.
+    void Process(const float *input, int64_t inputFirst, size_t inputCount,
+        size_t firstOutput, size_t outputCount, float *out) const;
+
+protected:
+    size_t m_sourceRate;
+    size_t m_targetRate;
+    uint64_t m_up;
+    uint64_t m_down;
+    size_t m_phaseCount;
+    size_t m_tapCount;
+    // m_tapCount weights for each phase
+    std::vector<float> m_filters;
+
+    // The first input sample and the filter of an output sample.
+    void locate(size_t output, int64_t *first, size_t *phase) const;
+};
+
+} // namespace mace
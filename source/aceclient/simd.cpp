@@ -0,0 +1,434 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "simd.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MACE_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define MACE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit AVX2 instructions in functions marked for it; MSVC always does.
+#if defined(MACE_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MACE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MACE_TARGET_AVX2
+#endif
+
+namespace mace {
+
+namespace {
+
+using LerpFunction = void (*)(const float *, const float *, float, float *, size_t);
+using DotFunction = float (*)(const float *, const float *, size_t);
+using FloatToInt16Function = void (*)(const float *, int16_t *, size_t);
+using Int16ToFloatFunction = void (*)(const int16_t *, float *, size_t);
+
+const float INT16_SCALE = 32768.0f;
+const float INT16_SCALE_INVERSE = 1.0f / 32768.0f;
+
+void lerpScalar(const float *left, const float *right, float t, float *out, size_t count) {
+    float const s = 1.0f - t;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = left[i] * s + right[i] * t;
+    }
+}
+
+float dotScalar(const float *a, const float *b, size_t count) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void floatToInt16Scalar(const float *in, int16_t *out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // clamped in float, so values beyond the int32 range do not overflow the conversion
+        float value = std::min(32767.0f, std::max(-32768.0f, in[i] * INT16_SCALE));
+        out[i] = static_cast<int16_t>(value);
+    }
+}
+
+void int16ToFloatScalar(const int16_t *in, float *out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = in[i] * INT16_SCALE_INVERSE;
+    }
+}
+
+#if defined(MACE_SIMD_X86)
+void lerpSSE(const float *left, const float *right, float t, float *out, size_t count) {
+    __m128 const s4 = _mm_set1_ps(1.0f - t);
+    __m128 const t4 = _mm_set1_ps(t);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(l, s4), _mm_mul_ps(r, t4)));
+    }
+    lerpScalar(left + i, right + i, t, out + i, count - i);
+}
+
+MACE_TARGET_AVX2
+void lerpAVX2(const float *left, const float *right, float t, float *out, size_t count) {
+    __m256 const s8 = _mm256_set1_ps(1.0f - t);
+    __m256 const t8 = _mm256_set1_ps(t);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 l = _mm256_loadu_ps(left + i);
+        __m256 r = _mm256_loadu_ps(right + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(l, s8), _mm256_mul_ps(r, t8)));
+    }
+    lerpSSE(left + i, right + i, t, out + i, count - i);
+}
+
+float dotSSE(const float *a, const float *b, size_t count) {
+    __m128 sum4 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sum4 = _mm_add_ps(sum4, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum4);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, count - i);
+}
+
+MACE_TARGET_AVX2
+float dotAVX2(const float *a, const float *b, size_t count) {
+    // two accumulators hide the latency of the additions
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    __m256 sum8 = _mm256_add_ps(sum0, sum1);
+    __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum4);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotSSE(a + i, b + i, count - i);
+}
+
+void floatToInt16SSE(const float *in, int16_t *out, size_t count) {
+    __m128 const scale = _mm_set1_ps(INT16_SCALE);
+    __m128 const top = _mm_set1_ps(32767.0f);
+    __m128 const bottom = _mm_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // max() returns its second operand when one is NaN, so NaN becomes the bottom
+        __m128 low = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), bottom), top);
+        __m128 high = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), bottom), top);
+        __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+
+void int16ToFloatSSE(const int16_t *in, float *out, size_t count) {
+    __m128 const scale = _mm_set1_ps(INT16_SCALE_INVERSE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        // sign extend by shifting the samples down from the high halves
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+
+MACE_TARGET_AVX2
+void floatToInt16AVX2(const float *in, int16_t *out, size_t count) {
+    __m256 const scale = _mm256_set1_ps(INT16_SCALE);
+    __m256 const top = _mm256_set1_ps(32767.0f);
+    __m256 const bottom = _mm256_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 low = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), bottom), top);
+        __m256 high = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), bottom), top);
+        // the packing works within 128 bit lanes; the permute restores the order
+        __m256i packed = _mm256_packs_epi32(_mm256_cvttps_epi32(low), _mm256_cvttps_epi32(high));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+    }
+    floatToInt16SSE(in + i, out + i, count - i);
+}
+
+MACE_TARGET_AVX2
+void int16ToFloatAVX2(const int16_t *in, float *out, size_t count) {
+    __m256 const scale = _mm256_set1_ps(INT16_SCALE_INVERSE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i samples = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+
+bool cpuHasAVX2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool const osxsave = (info[2] & (1 << 27)) != 0;
+    bool const avx = (info[2] & (1 << 28)) != 0;
+    // the OS must save the YMM registers
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#if defined(MACE_SIMD_NEON)
+void lerpNEON(const float *left, const float *right, float t, float *out, size_t count) {
+    float32x4_t const s4 = vdupq_n_f32(1.0f - t);
+    float32x4_t const t4 = vdupq_n_f32(t);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t l = vld1q_f32(left + i);
+        float32x4_t r = vld1q_f32(right + i);
+        vst1q_f32(out + i, vaddq_f32(vmulq_f32(l, s4), vmulq_f32(r, t4)));
+    }
+    lerpScalar(left + i, right + i, t, out + i, count - i);
+}
+
+float dotNEON(const float *a, const float *b, size_t count) {
+    float32x4_t sum4 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sum4 = vmlaq_f32(sum4, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float lanes[4];
+    vst1q_f32(lanes, sum4);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + dotScalar(a + i, b + i, count - i);
+}
+
+void floatToInt16NEON(const float *in, int16_t *out, size_t count) {
+    float32x4_t const scale = vdupq_n_f32(INT16_SCALE);
+    float32x4_t const top = vdupq_n_f32(32767.0f);
+    float32x4_t const bottom = vdupq_n_f32(-32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t low = vmulq_f32(vld1q_f32(in + i), scale);
+        float32x4_t high = vmulq_f32(vld1q_f32(in + i + 4), scale);
+        // NEON propagates NaN through min and max, so it is replaced by the bottom first
+        low = vminq_f32(vmaxq_f32(vbslq_f32(vceqq_f32(low, low), low, bottom), bottom), top);
+        high = vminq_f32(vmaxq_f32(vbslq_f32(vceqq_f32(high, high), high, bottom), bottom), top);
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(low)), vqmovn_s32(vcvtq_s32_f32(high))));
+    }
+    floatToInt16Scalar(in + i, out + i, count - i);
+}
+
+void int16ToFloatNEON(const int16_t *in, float *out, size_t count) {
+    float32x4_t const scale = vdupq_n_f32(INT16_SCALE_INVERSE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t samples = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), scale));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, count - i);
+}
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(MACE_SIMD_X86)
+    if (cpuHasAVX2()) {
+        return SimdAVX2;
+    }
+    return SimdSSE;
+#elif defined(MACE_SIMD_NEON)
+    return SimdNEON;
+#else
+    return SimdScalar;
+#endif
+}
+
+LerpFunction getLerpFunction(SimdLevel level) {
+    switch (level) {
+#if defined(MACE_SIMD_X86)
+    case SimdSSE:
+        return lerpSSE;
+    case SimdAVX2:
+        return lerpAVX2;
+#endif
+#if defined(MACE_SIMD_NEON)
+    case SimdNEON:
+        return lerpNEON;
+#endif
+    default:
+        return lerpScalar;
+    }
+}
+
+DotFunction getDotFunction(SimdLevel level) {
+    switch (level) {
+#if defined(MACE_SIMD_X86)
+    case SimdSSE:
+        return dotSSE;
+    case SimdAVX2:
+        return dotAVX2;
+#endif
+#if defined(MACE_SIMD_NEON)
+    case SimdNEON:
+        return dotNEON;
+#endif
+    default:
+        return dotScalar;
+    }
+}
+
+FloatToInt16Function getFloatToInt16Function(SimdLevel level) {
+    switch (level) {
+#if defined(MACE_SIMD_X86)
+    case SimdSSE:
+        return floatToInt16SSE;
+    case SimdAVX2:
+        return floatToInt16AVX2;
+#endif
+#if defined(MACE_SIMD_NEON)
+    case SimdNEON:
+        return floatToInt16NEON;
+#endif
+    default:
+        return floatToInt16Scalar;
+    }
+}
+
+Int16ToFloatFunction getInt16ToFloatFunction(SimdLevel level) {
+    switch (level) {
+#if defined(MACE_SIMD_X86)
+    case SimdSSE:
+        return int16ToFloatSSE;
+    case SimdAVX2:
+        return int16ToFloatAVX2;
+#endif
+#if defined(MACE_SIMD_NEON)
+    case SimdNEON:
+        return int16ToFloatNEON;
+#endif
+    default:
+        return int16ToFloatScalar;
+    }
+}
+
+} // namespace
+
+SimdLevel GetSimdLevel() {
+    static SimdLevel const level = detectSimdLevel();
+    return level;
+}
+
+bool IsSimdLevelSupported(SimdLevel level) {
+    SimdLevel const detected = GetSimdLevel();
+    switch (level) {
+    case SimdScalar:
+        return true;
+    case SimdSSE:
+        return detected == SimdSSE || detected == SimdAVX2;
+    case SimdAVX2:
+        return detected == SimdAVX2;
+    case SimdNEON:
+        return detected == SimdNEON;
+    }
+    return false;
+}
+
+const char *GetSimdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdScalar:
+        return "scalar";
+    case SimdSSE:
+        return "SSE";
+    case SimdAVX2:
+        return "AVX2";
+    case SimdNEON:
+        return "NEON";
+    }
+    return "unknown";
+}
+
+void Lerp(const float *left, const float *right, float t, float *out, size_t count) {
+    static LerpFunction const lerp = getLerpFunction(GetSimdLevel());
+    lerp(left, right, t, out, count);
+}
+
+void Lerp(SimdLevel level, const float *left, const float *right, float t, float *out, size_t count) {
+    if (!IsSimdLevelSupported(level)) {
+        level = SimdScalar;
+    }
+    getLerpFunction(level)(left, right, t, out, count);
+}
+
+float Dot(const float *a, const float *b, size_t count) {
+    static DotFunction const dot = getDotFunction(GetSimdLevel());
+    return dot(a, b, count);
+}
+
+float Dot(SimdLevel level, const float *a, const float *b, size_t count) {
+    if (!IsSimdLevelSupported(level)) {
+        level = SimdScalar;
+    }
+    return getDotFunction(level)(a, b, count);
+}
+
+void FloatToInt16(const float *in, int16_t *out, size_t count) {
+    static FloatToInt16Function const convert = getFloatToInt16Function(GetSimdLevel());
+    convert(in, out, count);
+}
+
+void FloatToInt16(SimdLevel level, const float *in, int16_t *out, size_t count) {
+    if (!IsSimdLevelSupported(level)) {
+        level = SimdScalar;
+    }
+    getFloatToInt16Function(level)(in, out, count);
+}
+
+void Int16ToFloat(const int16_t *in, float *out, size_t count) {
+    static Int16ToFloatFunction const convert = getInt16ToFloatFunction(GetSimdLevel());
+    convert(in, out, count);
+}
+
+void Int16ToFloat(SimdLevel level, const int16_t *in, float *out, size_t count) {
+    if (!IsSimdLevelSupported(level)) {
+        level = SimdScalar;
+    }
+    getInt16ToFloatFunction(level)(in, out, count);
+}
+
+} // namespace mace
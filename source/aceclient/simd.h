@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mace {
+
+// Instruction sets of the vectorized kernels; the best one supported by the CPU is picked at
+// runtime, so one binary runs on every machine.
+enum SimdLevel {
+    SimdScalar,
+    SimdSSE,
+    SimdAVX2,
+    SimdNEON,
+};
+
+// The instruction set used by the kernels, detected once.
+SimdLevel GetSimdLevel();
+bool IsSimdLevelSupported(SimdLevel level);
+const char *GetSimdLevelName(SimdLevel level);
+
+// out[i] = left[i] * (1 - t) + right[i] * t
+// out may be left or right, but must not partially overlap them.
+void Lerp(const float *left, const float *right, float t, float *out, size_t count);
+// The same with the given instruction set; an unsupported one falls back to scalar. For tests
+// and benchmarks.
+void Lerp(SimdLevel level, const float *left, const float *right, float t, float *out, size_t count);
+
+// The sum of a[i] * b[i]. The order of the additions, and so the rounding, depends on the
+// instruction set.
+float Dot(const float *a, const float *b, size_t count);
+float Dot(SimdLevel level, const float *a, const float *b, size_t count);
+
+// out[i] = in[i] * 32768, saturated to the int16 range on both sides and truncated toward zero.
+// NaN becomes -32768.
+void FloatToInt16(const float *in, int16_t *out, size_t count);
+void FloatToInt16(SimdLevel level, const float *in, int16_t *out, size_t count);
+// out[i] = in[i] / 32768
+void Int16ToFloat(const int16_t *in, float *out, size_t count);
+void Int16ToFloat(SimdLevel level, const int16_t *in, float *out, size_t count);
+
+} // namespace mace
@@ -21,6 +21,7 @@
 #include "animation_player.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <filesystem>
 #include <iostream>
@@ -32,6 +33,8 @@
 
 #include "aceclient/aceclient.h"
 #include "aceclient/audio.h"
+#include "aceclient/audio_loader.h"
+#include "aceclient/audio_source.h"
 #include "aceclient/animation.h"
 #include "aceclient/frame_receiver.h"
 #include "aceclient/logger.h"
@@ -98,6 +101,9 @@ MObject AceAnimationPlayer::statusCurrentFrame;
 MObject AceAnimationPlayer::triggerRequest;
 MObject AceAnimationPlayer::triggerLoad;
 
+// how long a load trigger waits for the audio before leaving it to the loader threads
+const std::chrono::milliseconds AUDIO_LOAD_WAIT(200);
+
 const std::unordered_map<AceClientStatus, MString> ACECLIENT_ERROR_MESSAGE_MAP = {
     {AceClientStatus::ERROR_UNAUTHENTICATED, "Invalid or empty API key provided. Please check and try again."},
     {AceClientStatus::ERROR_SSL_HANDSHAKE, "The remote server does not support SSL. Try using HTTP instead of HTTPS."},
@@ -106,7 +112,14 @@ const std::unordered_map<AceClientStatus, MString> ACECLIENT_ERROR_MESSAGE_MAP =
     {AceClientStatus::ERROR_CREDITS_EXPIRED, "Your API key has run out of cloud credits; Please get in touch with NVIDIA representatives for assistance."}
 };
 
-AceAnimationPlayer::AceAnimationPlayer(){}
+AceAnimationPlayer::AceAnimationPlayer(){
+    // players of the same audio and settings share one copy of the animation, and players
+    // triggered together share the stream that fetches it
+    client.SetUseClipCache(true);
+    client.SetCoalesceRequests(true);
+    // and players of the same audio file share one loaded copy of it
+    audioLoader.SetUseRegistry(true);
+}
 AceAnimationPlayer::~AceAnimationPlayer(){}
 
 void* AceAnimationPlayer::creator()
@@ -570,15 +583,15 @@ MStatus AceAnimationPlayer::compute( const MPlug& plug, MDataBlock& block) {
     MStatus return_status = MS::kUnknownParameter;
 
     if (plug == triggerLoad || plug == triggerRequest) {
-        // dirty audiofile input
-        return_status = updateAudioBuffer(block);
+        // dirty audiofile input; a request needs the audio, so it waits for the loader
+        return_status = updateAudioBuffer(block, false, plug == triggerRequest);
 
-        setOutput(block, statusAudioSamples, audioSamples.size());
+        setOutput(block, statusAudioSamples, getAudioSampleCount());
         setOutput(block, statusLoadedAudio, currentFile);
         if (return_status == MS::kSuccess) {
             // succeeded to load new audio, or re-using the existing audio
             MString msg("Audio data is loaded: ");
-            msg += (int)audioSamples.size();
+            msg += (int)getAudioSampleCount();
             msg += " samples.";
             MGlobal::displayInfo(msg);
             setOutput(block, statusLoaded, true);
@@ -590,8 +603,8 @@ MStatus AceAnimationPlayer::compute( const MPlug& plug, MDataBlock& block) {
     }
 
     if (plug == triggerRequest && url_string.length() > 1) {
-        if (audioSamples.size() < DefaultBufferLength) {
-            LOG_ERROR("Not enough audio samples to request animation: " << audioSamples.size() << " samples");
+        if (getAudioSampleCount() < DefaultBufferLength) {
+            LOG_ERROR("Not enough audio samples to request animation: " << getAudioSampleCount() << " samples");
             return MS::kFailure;
         }
 
@@ -630,8 +643,7 @@ MStatus AceAnimationPlayer::compute( const MPlug& plug, MDataBlock& block) {
             return MS::kFailure;
         }
 
-        std::vector<std::string> names = client.GetBlendshapeNames();
-        return_status = setOutputArray(block, outputBlendshapeNames, names);
+        return_status = setOutputArray(block, outputBlendshapeNames, client.GetBlendshapeNamesView());
         if (return_status != MS::kSuccess) {
             MGlobal::displayError("Cannot update output blendshape names");
         }
@@ -643,8 +655,7 @@ MStatus AceAnimationPlayer::compute( const MPlug& plug, MDataBlock& block) {
             return MS::kFailure;
         }
 
-        std::vector<std::string> names = client.GetEmotionStateNames();
-        return_status = setOutputArray(block, outputEmotionStateNames, names);
+        return_status = setOutputArray(block, outputEmotionStateNames, client.GetEmotionStateNamesView());
         if (return_status != MS::kSuccess) {
             MGlobal::displayError("Cannot update output emotion state names");
         }
@@ -684,14 +695,15 @@ MStatus AceAnimationPlayer::updateFrame(MDataBlock &block) {
     size_t frame_idx = client.GetFrameIndex((float)audio_position);
 
     // else: dirty current time
-    std::vector<float> weights = getBlendshapeWeights(block, frame_idx);
+    // the views read the client's frames directly, without copying them
+    mace::ArrayView<const float> weights = getBlendshapeWeights(block, frame_idx);
     return_status = setOutputArray(block, outputWeights, weights);
     if (return_status != MS::kSuccess) {
         MGlobal::displayError("Cannot update output blendshape weights.");
         return return_status;
     }
 
-    std::vector<float> emotion_state = getOutputEmotionState(block, frame_idx);
+    mace::ArrayView<const float> emotion_state = getOutputEmotionState(block, frame_idx);
     return_status = setOutputArray(block, outputEmotionState, emotion_state);
     if (return_status != MS::kSuccess) {
         MGlobal::displayError("Cannot update output emotion state.");
@@ -706,10 +718,10 @@ MStatus AceAnimationPlayer::updateFrame(MDataBlock &block) {
     return return_status;
 }
 
-std::vector<float> AceAnimationPlayer::getBlendshapeWeights(MDataBlock &block, size_t frame_index) {
-    std::vector<float> weights = client.GetBlendshapeWeights(frame_index);
+mace::ArrayView<const float> AceAnimationPlayer::getBlendshapeWeights(MDataBlock &block, size_t frame_index) {
+    mace::ArrayView<const float> weights = client.GetBlendshapeWeightsView(frame_index);
 
-    // NOTE: disabled local compute for this version
+    // NOTE: disabled local compute for this version; it needs the weights copied out of the view
     // for (size_t i = 0; i < std::min(BLENDSHAPE_COUNT, weights.size()); i++) {
     //     MDataHandle bs_gain = block.inputValue(blendshapeMultipliers[i]);
     //     MDataHandle bs_offset = block.inputValue(blendshapeOffsets[i]);
@@ -720,8 +732,8 @@ std::vector<float> AceAnimationPlayer::getBlendshapeWeights(MDataBlock &block, s
     return weights;
 }
 
-std::vector<float> AceAnimationPlayer::getOutputEmotionState(MDataBlock &block, size_t frame_index) {
-    return client.GetEmotionState(frame_index);
+mace::ArrayView<const float> AceAnimationPlayer::getOutputEmotionState(MDataBlock &block, size_t frame_index) {
+    return client.GetEmotionStateView(frame_index);
 }
 
 std::vector<std::string> AceAnimationPlayer::getBlendshapeNames() {
@@ -733,7 +745,7 @@ MTime AceAnimationPlayer::getCurrentAudioTime(MDataBlock &block) {
     // get the adjusted audio time
     double t = getTimeAsSeconds(block, time);
 
-    double audio_length = audioSamples.size() / (double)audioSamplerate;
+    double audio_length = getAudioSampleCount() / (double)audioSamplerate;
     double audio_offset = getTimeAsSeconds(block, audioOffset);  // +offset: padding in front of the audio
     double audio_start = clamp(getTimeAsSeconds(block, audioStart), 0.0f, audio_length);
     double audio_end = getTimeAsSeconds(block, audioEnd);
@@ -754,9 +766,7 @@ double AceAnimationPlayer::getTimeAsSeconds(MDataBlock &block, MObject &time_att
     return current.asUnits(MTime::kSeconds);
 }
 
-MStatus AceAnimationPlayer::updateAudioBuffer(MDataBlock &block, bool force) {
-    MStatus return_status = MS::kFailure;
-
+MStatus AceAnimationPlayer::updateAudioBuffer(MDataBlock &block, bool force, bool wait) {
     // input audiofile
     MString audiofile_mstring = block.inputValue(audiofile).asString();
     std::filesystem::path audiofile_path(audiofile_mstring.asUTF8());
@@ -773,18 +783,48 @@ MStatus AceAnimationPlayer::updateAudioBuffer(MDataBlock &block, bool force) {
         return MS::kSuccess;
     }
 
-    // load and update audio data
-    LOG_INFO("Loading a new audio file: " + audiofile_path.string());
-    audioSamples.clear();
-    return_status = loadAudioFile(audiofile_mstring, audioSamples);  // fills audioSamples vector
+    // decode on the loader threads, so switching files does not block the UI
+    if (audiofile_mstring != pendingFile || force || !pendingAudio.valid()) {
+        LOG_INFO("Loading a new audio file: " + audiofile_path.string());
+        // re-evaluate the load trigger once the audio is ready, if this compute gave up waiting
+        MString node_name = MFnDependencyNode(thisMObject()).name();
+        MString command = "if (`objExists " + node_name + "`) { dgdirty " + node_name + ".triggerLoad; dgeval "
+            + node_name + ".triggerLoad; }";
+        auto notify = std::make_shared<std::atomic<bool>>(false);
+        pendingNotify = notify;
+        pendingFile = audiofile_mstring;
+        pendingAudio = audioLoader.Load(audiofile_mstring.asUTF8(), audioSamplerate,
+            [command, notify](mace::LoadedAudio const &) {
+                if (notify->load()) {
+                    MGlobal::executeCommandOnIdle(command);
+                }
+            });
+    }
 
-    if (return_status != MS::kSuccess || audioSamples.size() < 1) {
+    if (!wait && pendingAudio.wait_for(AUDIO_LOAD_WAIT) != std::future_status::ready) {
+        pendingNotify->store(true);
+        if (pendingAudio.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            std::string msg("Loading the audio file in the background: " + audiofile_path.string());
+            MGlobal::displayInfo(msg.c_str());
+            return MS::kFailure;
+        }
+    }
+
+    mace::LoadedAudio loaded = pendingAudio.get();
+    pendingAudio = std::shared_future<mace::LoadedAudio>();
+    pendingNotify.reset();
+    pendingFile = "";
+
+    if (loaded.status != AceClientStatus::OK) {
+        audioSource.reset();
+        currentFile = "";
         std::string msg("No audio samples from the file: " + audiofile_path.string());
         MGlobal::displayError(msg.c_str());
         return MS::kFailure;
     }
 
     // succeeded
+    audioSource = loaded.source;
     currentFile = audiofile_mstring;
     return MS::kSuccess;
 }
@@ -864,7 +904,7 @@ MStatus AceAnimationPlayer::updateAnimation(MDataBlock &block) {
     // start communication
     MComputation computation;
     computation.beginComputation();
-    svc_status = client.UpdateAnimation(audioSamples);
+    svc_status = client.UpdateAnimation(*audioSource);
     computation.endComputation();
 
     if (svc_status != AceClientStatus::OK) {
@@ -925,18 +965,8 @@ mace::AceEmotionState AceAnimationPlayer::getEmotionState(MDataBlock &block) {
     return params;
 }
 
-MStatus AceAnimationPlayer::loadAudioFile(MString &filepath, std::vector<int16_t> &outBuffer) {
-    std::vector<int16_t> padding_before(DefaultBufferOffset, 0);  // (4160, 0);
-    std::vector<int16_t> padding_after(DefaultBufferOffset, 0);  // (4160, 0);
-
-    std::vector<float> buffer_f = get_file_wav_content(filepath.asUTF8(), audioSamplerate);
-    std::vector<int16_t> buffer = convert_float_to_int16(buffer_f);
-
-    if(buffer.size() == 0) return MStatus::kFailure;
-
-    outBuffer.insert(outBuffer.end(), buffer.begin(), buffer.end());
-
-    return MS::kSuccess;
+size_t AceAnimationPlayer::getAudioSampleCount() {
+    return audioSource ? audioSource->GetSampleCount() : 0;
 }
 
 std::vector<float> AceAnimationPlayer::getInputArray(
@@ -957,7 +987,7 @@ std::vector<float> AceAnimationPlayer::getInputArray(
 }
 
 MStatus AceAnimationPlayer::setOutputArray(
-    MDataBlock &block, MObject &attribute, std::vector<float> &values, bool setClean) {
+    MDataBlock &block, MObject &attribute, mace::ArrayView<const float> values, bool setClean) {
 
     MStatus return_status = MS::kFailure;
     MArrayDataHandle array_handle = block.outputArrayValue(attribute, &return_status);
@@ -982,7 +1012,7 @@ MStatus AceAnimationPlayer::setOutputArray(
 }
 
 MStatus AceAnimationPlayer::setOutputArray(
-    MDataBlock &block, MObject &attribute, std::vector<std::string> &values, bool setClean)
+    MDataBlock &block, MObject &attribute, mace::ArrayView<const std::string> values, bool setClean)
 {
     MStatus return_status = MS::kFailure;
     MArrayDataHandle array_handle = block.outputArrayValue(attribute, &return_status);
@@ -994,7 +1024,7 @@ MStatus AceAnimationPlayer::setOutputArray(
 
     MArrayDataBuilder array_builder = array_handle.builder();
     int i = 0;
-    for (std::string value : values) {
+    for (std::string const &value : values) {
         MDataHandle data_handle = array_builder.addElement(i++, &return_status);
         data_handle.setString(MString(value.c_str()));
     }
@@ -38,6 +38,8 @@
 #include <maya/MFnCompoundAttribute.h>
 #include <maya/MFnPluginData.h>
 
+#include <atomic>
+#include <future>
 #include <memory>
 #include <vector>
 #include <string>
@@ -45,7 +47,10 @@
 #include "aceclient/frame_receiver.h"
 #include "aceclient/parameters.h"
 #include "aceclient/animation.h"
+#include "aceclient/array_view.h"
 #include "aceclient/audio.h"
+#include "aceclient/audio_loader.h"
+#include "aceclient/audio_source.h"
 
 #include "common/names.h"
 
@@ -63,11 +68,11 @@ public:
 
     MStatus updateClientParameters(MDataBlock &block);
     void displayClientParameters();
-    MStatus updateAudioBuffer(MDataBlock &block, bool force=false);
+    MStatus updateAudioBuffer(MDataBlock &block, bool force=false, bool wait=false);
     MStatus updateAnimation(MDataBlock &block);
     MStatus updateFrame(MDataBlock &block);
-    std::vector<float> getBlendshapeWeights(MDataBlock &block, size_t frame_index);
-    std::vector<float> getOutputEmotionState(MDataBlock &block, size_t frame_index);
+    mace::ArrayView<const float> getBlendshapeWeights(MDataBlock &block, size_t frame_index);
+    mace::ArrayView<const float> getOutputEmotionState(MDataBlock &block, size_t frame_index);
     std::vector<std::string> getBlendshapeNames();
 
     MTime getCurrentAudioTime(MDataBlock &block);
@@ -138,11 +143,17 @@ public:
     static const char* typeName;
 
 private:
-    std::vector<int16_t> audioSamples;
+    std::shared_ptr<const mace::AudioSource> audioSource;
     size_t audioSamplerate = DefaultSampleRate;
     MString currentFile = "";
     MString currentUrl = "";
 
+    // the file being decoded on the loader threads, adopted by a later compute
+    mace::AudioLoader audioLoader;
+    std::shared_future<mace::LoadedAudio> pendingAudio;
+    std::shared_ptr<std::atomic<bool>> pendingNotify;
+    MString pendingFile = "";
+
     mace::AnimationClient client;
     long long lastUpdatedTime = 0;
     int lastUpdatedFrame = -(1 << 15);
@@ -151,7 +162,7 @@ private:
     mace::AceEmotionParameters getEmotionParameters(MDataBlock &block);
     mace::AceEmotionState getEmotionState(MDataBlock &block);
 
-    MStatus loadAudioFile(MString &audiofile, std::vector<int16_t> &outBuffer);
+    size_t getAudioSampleCount();
 
     std::vector<float> getInputArray(MDataBlock &block, MObject &attribute, MStatus *return_status=nullptr);
 
@@ -165,7 +176,7 @@ private:
     MStatus setOutput(MDataBlock &block, MObject &attribute, float value, bool setClean=true);
     MStatus setOutput(MDataBlock &block, MObject &attribute, bool value, bool setClean=true);
     MStatus setOutputArray(
-        MDataBlock &block, MObject &attribute, std::vector<float> &values, bool setClean=true);
+        MDataBlock &block, MObject &attribute, mace::ArrayView<const float> values, bool setClean=true);
     MStatus setOutputArray(
-        MDataBlock &block, MObject &attribute, std::vector<std::string> &values, bool setClean=true);
+        MDataBlock &block, MObject &attribute, mace::ArrayView<const std::string> values, bool setClean=true);
 };
@@ -39,6 +39,7 @@
 #include <maya/MFnCompoundAttribute.h>
 #include <maya/MFnPluginData.h>
 
+#include "aceclient/audio_loader.h"
 #include "nodes/animation_player.h"
 #include "commands/request_animation.h"
 #include "commands/export_config_parameters.h"
@@ -70,5 +71,8 @@ MStatus uninitializePlugin( MObject obj)
     plugin.deregisterCommand(AceRequestAnimationCommand::commandName);
     plugin.deregisterCommand(AceExportConfigParametersCommand::commandName);
 
+    // join the loader threads here rather than while the library is being unloaded
+    mace::AudioLoader::Shutdown();
+
     return result;
 }
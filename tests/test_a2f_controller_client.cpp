@@ -18,6 +18,9 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
+#include <chrono>
+#include <future>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "grpc++/grpc++.h"
@@ -25,9 +28,11 @@
 #include "ace_grpc_cpp/nvidia_ace.services.a2f_controller.v1.grpc.pb.h"
 #include "ace_grpc_cpp/nvidia_ace.services.a2f_controller.v1_mock.grpc.pb.h"
 #include "ace_grpc_cpp/health_mock.grpc.pb.h"
+#include "ace_grpc_cpp/nvidia_ace.emotion_aggregate.v1.pb.h"
 
 #include "aceclient/animation.h"
 #include "aceclient/parameters.h"
+#include "utils.h"
 
 using ::testing::_;
 using ::testing::AtLeast;
@@ -223,6 +228,67 @@ TEST_F(TestA2FControllerClient, ProcessAudioStreamSucceeded) {
   }
 }
 
+TEST_F(TestA2FControllerClient, ProcessAudioStreamReadsWhileWriting) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  AnimationDataStream firstResponse;
+  firstResponse.mutable_animation_data_stream_header()->mutable_skel_animation_header()->add_blend_shapes("face_0");
+  AnimationDataStream fakeAnimationData;
+  fakeAnimationData.mutable_animation_data()->mutable_skel_animation()->add_blend_shape_weights()->add_values(0.5f);
+
+  // The upload cannot complete until the first frame has been read.
+  std::promise<void> frameRead;
+  std::shared_future<void> frameReadFuture = frameRead.get_future().share();
+  EXPECT_CALL(*stream, Read(_))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&firstResponse)), testing::Return(true)))
+    .WillOnce(testing::Invoke([&](AnimationDataStream *response) {
+      response->CopyFrom(fakeAnimationData);
+      frameRead.set_value();
+      return true;
+    }))
+    .WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(*stream, Write(_, _)).Times(AtLeast(3)).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(*stream, WritesDone()).Times(1).WillOnce(testing::Invoke([&]() {
+    return frameReadFuture.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  }));
+  EXPECT_CALL(*stream, Finish()).Times(1).WillRepeatedly(testing::Return(grpc::Status::OK));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000 * 3);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames);
+
+  // Assert
+  ASSERT_EQ(status, AceClientStatus::OK);
+  EXPECT_EQ(out_frames.size(), 1);
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamWriteFailed) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  EXPECT_CALL(*stream, Read(_)).WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(*stream, WritesDone()).Times(0);
+  EXPECT_CALL(*stream, Finish()).WillRepeatedly(testing::Return(grpc::Status::OK));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames);
+
+  // Assert
+  ASSERT_NE(status, AceClientStatus::OK);
+  EXPECT_EQ(out_frames.size(), 0);
+}
+
 TEST_F(TestA2FControllerClient, ProcessAudioStreamFirstResponseIsNotHeader) {
   std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
   std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
@@ -249,6 +315,414 @@ TEST_F(TestA2FControllerClient, ProcessAudioStreamFirstResponseIsNotHeader) {
   ASSERT_EQ(status, AceClientStatus::ERROR_UNEXPECTED_OUTPUT);
 }
 
+TEST_F(TestA2FControllerClient, ProcessAudioStreamUnknownResponse) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  AnimationDataStream firstResponse;
+  firstResponse.mutable_animation_data_stream_header();
+  // none of the known message types
+  AnimationDataStream unknownResponse;
+
+  // The upload is still running when the unknown response arrives, and fails once the stream is
+  // given up on.
+  std::promise<void> unknownRead;
+  std::shared_future<void> unknownReadFuture = unknownRead.get_future().share();
+  EXPECT_CALL(*stream, Read(_))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&firstResponse)), testing::Return(true)))
+    .WillOnce(testing::Invoke([&](AnimationDataStream *response) {
+      response->CopyFrom(unknownResponse);
+      unknownRead.set_value();
+      return true;
+    }));
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Invoke([&](const AudioStream &, grpc::WriteOptions) {
+    unknownReadFuture.wait_for(std::chrono::seconds(5));
+    return false;
+  }));
+  EXPECT_CALL(*stream, WritesDone()).Times(0);
+  // the final status is still read
+  EXPECT_CALL(*stream, Finish()).Times(1).WillOnce(testing::Return(grpc::Status::OK));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames);
+
+  // Assert
+  ASSERT_EQ(status, AceClientStatus::ERROR_UNEXPECTED_OUTPUT);
+  EXPECT_EQ(out_frames.size(), 0);
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamClassifiesStreamErrors) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  EXPECT_CALL(*stream, Read(_)).WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(*stream, Finish()).Times(1).WillOnce(testing::Return(grpc::Status(grpc::StatusCode::INTERNAL,
+    "failed to open stateful work request: rpc error: code = Unauthenticated desc = invalid response from UAM")));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames);
+
+  // Assert
+  ASSERT_EQ(status, AceClientStatus::ERROR_UNAUTHENTICATED);
+}
+
+// Sends the audio and returns the sizes of the audio chunks written to the stream, in samples.
+std::vector<size_t> WriteChunks(mace::ChunkingOptions const &options, size_t sample_count, std::vector<float> *time_codes) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  EXPECT_EQ(client->SetChunkingOptions(options), AceClientStatus::OK);
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  AnimationDataStream firstResponse;
+  firstResponse.mutable_animation_data_stream_header();
+  std::vector<size_t> chunkSizes;
+  EXPECT_CALL(*stream, Read(_))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&firstResponse)), testing::Return(true)))
+    .WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Invoke([&](const AudioStream &message, grpc::WriteOptions) {
+    if (message.has_audio_with_emotion()) {
+      chunkSizes.push_back(message.audio_with_emotion().audio_buffer().size() / sizeof(int16_t));
+      time_codes->push_back(message.audio_with_emotion().emotions(0).time_code());
+    }
+    return true;
+  }));
+  EXPECT_CALL(*stream, WritesDone()).WillOnce(testing::Return(true));
+  EXPECT_CALL(*stream, Finish()).WillOnce(testing::Return(grpc::Status::OK));
+
+  std::vector<int16_t> fake_buffer(sample_count);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  EXPECT_EQ(client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames), AceClientStatus::OK);
+  EXPECT_EQ(client->GetLastRequestStats().chunk_sizes, chunkSizes);
+  return chunkSizes;
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamChunkSizes) {
+  mace::ChunkingOptions options;
+  std::vector<float> timeCodes;
+  EXPECT_EQ(WriteChunks(options, 40000, &timeCodes), std::vector<size_t>({16000, 16000, 8000}));
+  EXPECT_EQ(timeCodes, std::vector<float>({0.0f, 1.0f, 2.0f}));
+
+  options.chunk_size = 4000;
+  EXPECT_EQ(WriteChunks(options, 10000, &timeCodes), std::vector<size_t>({4000, 4000, 2000}));
+
+  options.mode = mace::ChunkAdaptive;
+  options.chunk_size = 16000;
+  options.initial_chunk_size = 1600;
+  timeCodes.clear();
+  EXPECT_EQ(WriteChunks(options, 40000, &timeCodes), std::vector<size_t>({1600, 3200, 6400, 12800, 16000}));
+  EXPECT_FLOAT_EQ(timeCodes[1], 0.1f);
+
+  options.chunk_size = 0;
+  A2FControllerClient client(std::make_shared<MockA2FControllerServiceStub>(), API_KEY, FUNCTION_ID);
+  EXPECT_EQ(client.SetChunkingOptions(options), AceClientStatus::ERROR_INVALID_INPUT);
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamCountsBytes) {
+  for (auto mode : {mace::CompressionNone, mace::CompressionGzip}) {
+    std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+    std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+    client->SetCompression(mode);
+    auto stream = new MockClientReaderWriter();
+    EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+    AnimationDataStream firstResponse;
+    firstResponse.mutable_animation_data_stream_header()->mutable_skel_animation_header()->add_blend_shapes("face_0");
+    size_t bytesWritten = 0;
+    EXPECT_CALL(*stream, Read(_))
+      .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&firstResponse)), testing::Return(true)))
+      .WillRepeatedly(testing::Return(false));
+    EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Invoke([&](const AudioStream &message, grpc::WriteOptions) {
+      bytesWritten += message.ByteSizeLong();
+      return true;
+    }));
+    EXPECT_CALL(*stream, WritesDone()).WillOnce(testing::Return(true));
+    EXPECT_CALL(*stream, Finish()).WillOnce(testing::Return(grpc::Status::OK));
+
+    // Act
+    std::vector<int16_t> fake_buffer(16000 * 2);
+    std::vector<AnimDataFrame> out_frames;
+    mace::AceEmotionState emotionState;
+    ASSERT_EQ(client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames), AceClientStatus::OK);
+
+    // Assert
+    auto const &stats = client->GetLastRequestStats();
+    EXPECT_EQ(stats.bytes_sent, bytesWritten);
+    EXPECT_EQ(stats.bytes_received, firstResponse.ByteSizeLong());
+    if (mode == mace::CompressionNone) {
+      EXPECT_EQ(stats.compressed_bytes_sent, stats.bytes_sent);
+      EXPECT_EQ(stats.sampled_bytes_sent, stats.bytes_sent);
+    } else {
+      // not estimated unless asked for
+      EXPECT_EQ(stats.compressed_bytes_sent, 0);
+      EXPECT_EQ(stats.sampled_messages, 0);
+    }
+  }
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamEstimatesCompression) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  client->SetCompression(mace::CompressionGzip);
+  client->SetCompressionEstimate(2);
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+  EXPECT_CALL(*stream, Read(_)).WillRepeatedly(testing::Return(false));
+  size_t messagesWritten = 0;
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Invoke([&](const AudioStream &, grpc::WriteOptions) {
+    messagesWritten++;
+    return true;
+  }));
+  EXPECT_CALL(*stream, WritesDone()).WillOnce(testing::Return(true));
+  EXPECT_CALL(*stream, Finish()).WillOnce(testing::Return(grpc::Status::OK));
+
+  std::vector<int16_t> fake_buffer(16000 * 2);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames);
+
+  // the header and the first chunk are estimated, the rest are only sent
+  auto const &stats = client->GetLastRequestStats();
+  EXPECT_GT(messagesWritten, 2);
+  EXPECT_EQ(stats.sampled_messages, 2);
+  EXPECT_LT(stats.sampled_bytes_sent, stats.bytes_sent);
+  // silence compresses well
+  EXPECT_GT(stats.compressed_bytes_sent, 0);
+  EXPECT_LT(stats.compressed_bytes_sent, stats.sampled_bytes_sent / 2);
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamLongResponse) {
+  // more messages than are decoded on the arena between two resets
+  const int NUM_FRAMES = 1000;
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  AnimationDataStream firstResponse;
+  firstResponse.mutable_animation_data_stream_header()->mutable_skel_animation_header()->add_blend_shapes("face_0");
+  int messageCount = 0;
+  EXPECT_CALL(*stream, Read(_))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&firstResponse)), testing::Return(true)))
+    .WillRepeatedly(testing::Invoke([&](AnimationDataStream *response) {
+      if (messageCount == NUM_FRAMES) {
+        return false;
+      }
+      // the arena may have been reset; the message must still be usable
+      response->Clear();
+      auto animationData = response->mutable_animation_data();
+      auto weights = animationData->mutable_skel_animation()->add_blend_shape_weights();
+      weights->set_time_code(messageCount / 30.0);
+      weights->add_values(static_cast<float>(messageCount));
+      nvidia_ace::emotion_aggregate::v1::EmotionAggregate emotionAggregate;
+      (*emotionAggregate.add_a2f_smoothed_output()->mutable_emotion())["joy"] = messageCount / 1000.0f;
+      (*animationData->mutable_metadata())["emotion_aggregate"].PackFrom(emotionAggregate);
+      messageCount++;
+      return true;
+    }));
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(*stream, WritesDone()).WillOnce(testing::Return(true));
+  EXPECT_CALL(*stream, Finish()).WillOnce(testing::Return(grpc::Status::OK));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000);
+  std::vector<AnimDataFrame> out_frames;
+  mace::AceEmotionState emotionState;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &out_frames);
+
+  // Assert
+  ASSERT_EQ(status, AceClientStatus::OK);
+  ASSERT_EQ(out_frames.size(), NUM_FRAMES);
+  for (int i = 0; i < NUM_FRAMES; ++i) {
+    EXPECT_DOUBLE_EQ(out_frames[i].timestamp, i / 30.0);
+    EXPECT_FLOAT_EQ(out_frames[i].blend_shape_weights[0], static_cast<float>(i));
+    ASSERT_EQ(out_frames[i].emotion_state.size(), 10);
+    // joy
+    EXPECT_FLOAT_EQ(out_frames[i].emotion_state[6], i / 1000.0f);
+  }
+}
+
+// Accepts every message without doing anything, so that only the client allocates.
+class NullClientReaderWriter : public grpc::ClientReaderWriterInterface<AudioStream, AnimationDataStream> {
+ public:
+  bool Write(const AudioStream& request, grpc::WriteOptions options) override { return true; }
+  bool Read(AnimationDataStream* response) override { return false; }
+  bool WritesDone() override { return true; }
+  grpc::Status Finish() override { return grpc::Status::OK; }
+  void WaitForInitialMetadata() override {}
+  bool NextMessageSize(uint32_t *sz) override { return false; }
+};
+
+class UploadingA2FControllerClient : public A2FControllerClient {
+ public:
+  using A2FControllerClient::A2FControllerClient;
+  using A2FControllerClient::writeAudioStream;
+};
+
+TEST_F(TestA2FControllerClient, BenchmarkPerChunkAllocations) {
+  const size_t CHUNK_SIZE = 160;
+  const size_t CHUNK_COUNT = 1000;
+  std::vector<int16_t> fake_buffer(CHUNK_SIZE * CHUNK_COUNT * 2);
+  mace::AceEmotionState emotionState;
+  auto stream = std::make_shared<NullClientReaderWriter>();
+
+  // the allocations per chunk of building every message from scratch, as it was done before
+  size_t legacyAllocations;
+  {
+    AllocationCounter counter;
+    for (size_t offset = 0; offset < CHUNK_SIZE * CHUNK_COUNT; offset += CHUNK_SIZE) {
+      AudioStream message;
+      auto audioWithEmotion = message.mutable_audio_with_emotion();
+      audioWithEmotion->set_audio_buffer(fake_buffer.data() + offset, CHUNK_SIZE * sizeof(int16_t));
+      auto emotionWithTimeCode = audioWithEmotion->add_emotions();
+      emotionWithTimeCode->set_time_code(offset / 16000.0f);
+      auto emotion = emotionWithTimeCode->mutable_emotion();
+      for (auto name : {"amazement", "anger", "cheekiness", "disgust", "fear", "grief", "joy", "out_of_breath", "pain", "sadness"}) {
+        emotion->insert({name, 0.0f});
+      }
+      stream->Write(message, grpc::WriteOptions());
+    }
+    legacyAllocations = counter.GetCount();
+  }
+
+  // the difference between uploading N and 2N chunks leaves out the per-request allocations
+  UploadingA2FControllerClient client(std::make_shared<MockA2FControllerServiceStub>(), API_KEY, FUNCTION_ID);
+  mace::ChunkingOptions options;
+  options.chunk_size = CHUNK_SIZE;
+  client.SetChunkingOptions(options);
+  size_t allocations[2];
+  for (size_t i = 0; i < 2; ++i) {
+    AllocationCounter counter;
+    ASSERT_EQ(client.writeAudioStream(stream, fake_buffer.data(), CHUNK_SIZE * CHUNK_COUNT * (i + 1), emotionState), AceClientStatus::OK);
+    allocations[i] = counter.GetCount();
+  }
+  double legacyPerChunk = static_cast<double>(legacyAllocations) / CHUNK_COUNT;
+  double perChunk = static_cast<double>(allocations[1] - allocations[0]) / CHUNK_COUNT;
+  std::cout << "Allocations per chunk: " << legacyPerChunk << " (per-chunk messages), " << perChunk << " (reused message)" << std::endl;
+
+  EXPECT_LT(perChunk, 0.1);
+  EXPECT_LT(perChunk, legacyPerChunk);
+}
+
+// Records the order of the callbacks
+class RecordingReceiver : public mace::FrameReceiver {
+public:
+  void OnHeader(std::vector<std::string> const &blend_shape_names,
+      std::vector<std::string> const &emotion_state_names) override {
+    events.push_back("header");
+    names = blend_shape_names;
+  }
+  void OnFrames(std::vector<AnimDataFrame> &&frames) override {
+    events.push_back("frames:" + std::to_string(frames.size()));
+    for (auto &frame : frames) {
+      timestamps.push_back(frame.timestamp);
+    }
+  }
+  void OnStatus(int code, std::string const &message) override {
+    events.push_back("status:" + message);
+  }
+  void OnComplete(AceClientStatus status) override {
+    events.push_back("complete:" + std::to_string(status));
+  }
+
+  std::vector<std::string> events;
+  std::vector<std::string> names;
+  std::vector<double> timestamps;
+};
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamDeliversFramesIncrementally) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  AnimationDataStream firstResponse;
+  firstResponse.mutable_animation_data_stream_header()->mutable_skel_animation_header()->add_blend_shapes("face_0");
+  AnimationDataStream frame0;
+  auto weights0 = frame0.mutable_animation_data()->mutable_skel_animation()->add_blend_shape_weights();
+  weights0->set_time_code(0.0);
+  weights0->add_values(0.1f);
+  AnimationDataStream infoStatus;
+  infoStatus.mutable_status()->set_code(nvidia_ace::status::v1::Status_Code_INFO);
+  infoStatus.mutable_status()->set_message("info");
+  AnimationDataStream frame1;
+  auto skelAnimation1 = frame1.mutable_animation_data()->mutable_skel_animation();
+  for (int i = 1; i < 3; ++i) {
+    auto weights = skelAnimation1->add_blend_shape_weights();
+    weights->set_time_code(i / 30.0);
+    weights->add_values(0.1f * i);
+  }
+  AnimationDataStream successStatus;
+  successStatus.mutable_status()->set_code(nvidia_ace::status::v1::Status_Code_SUCCESS);
+
+  // The first frames must reach the receiver before the stream ends.
+  RecordingReceiver receiver;
+  EXPECT_CALL(*stream, Read(_))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&firstResponse)), testing::Return(true)))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&frame0)), testing::Return(true)))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&infoStatus)), testing::Return(true)))
+    .WillOnce(testing::Invoke([&](AnimationDataStream *response) {
+      EXPECT_EQ(receiver.timestamps.size(), 1);
+      response->CopyFrom(frame1);
+      return true;
+    }))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&successStatus)), testing::Return(true)));
+  EXPECT_CALL(*stream, Write(_, _)).Times(AtLeast(3)).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(*stream, WritesDone()).Times(1).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(*stream, Finish()).Times(1).WillRepeatedly(testing::Return(grpc::Status::OK));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000);
+  mace::AceEmotionState emotionState;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &receiver);
+
+  // Assert
+  ASSERT_EQ(status, AceClientStatus::OK);
+  std::vector<std::string> expectedEvents = {"header", "frames:1", "status:info", "frames:2", "complete:0"};
+  EXPECT_EQ(receiver.events, expectedEvents);
+  EXPECT_EQ(receiver.names, std::vector<std::string>({"face_0"}));
+  EXPECT_EQ(receiver.timestamps.size(), 3);
+}
+
+TEST_F(TestA2FControllerClient, ProcessAudioStreamCompletesReceiverOnError) {
+  std::shared_ptr<MockA2FControllerServiceStub> stub = std::make_shared<MockA2FControllerServiceStub>();
+  std::unique_ptr<A2FControllerClient> client(new A2FControllerClient(stub, API_KEY, FUNCTION_ID));
+  auto stream = new MockClientReaderWriter();
+  EXPECT_CALL(*stub, ProcessAudioStreamRaw(_)).WillOnce(Return(stream));
+
+  AnimationDataStream fakeAnimationData;
+  fakeAnimationData.mutable_animation_data();
+
+  EXPECT_CALL(*stream, Read(_))
+    .WillOnce(testing::DoAll(testing::WithArg<0>(copy(&fakeAnimationData)), testing::Return(true)));
+  EXPECT_CALL(*stream, Write(_, _)).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(*stream, WritesDone()).WillRepeatedly(testing::Return(true));
+  EXPECT_CALL(*stream, Finish()).WillRepeatedly(testing::Return(grpc::Status::OK));
+
+  // Act
+  std::vector<int16_t> fake_buffer(16000);
+  mace::AceEmotionState emotionState;
+  RecordingReceiver receiver;
+  auto status = client->ProcessAudioStream(fake_buffer.data(), fake_buffer.size(), emotionState, &receiver);
+
+  // Assert
+  ASSERT_EQ(status, AceClientStatus::ERROR_UNEXPECTED_OUTPUT);
+  std::vector<std::string> expectedEvents = {"complete:" + std::to_string(AceClientStatus::ERROR_UNEXPECTED_OUTPUT)};
+  EXPECT_EQ(receiver.events, expectedEvents);
+}
+
 TEST_F(TestA2FControllerClient, TestSetup) {
   const std::string test_api_key = "_api_key_";
   const std::string test_function_id = "_function_id_";
@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "aceclient/animation_track.h"
+
+#include <gtest/gtest.h>
+
+using mace::AnimationTrack;
+
+namespace {
+    AnimDataFrame makeFrame(double timestamp, std::vector<float> const &weights, std::vector<float> const &emotions = {}) {
+        AnimDataFrame frame;
+        frame.timestamp = timestamp;
+        frame.blend_shape_weights = weights;
+        frame.emotion_state = emotions;
+        return frame;
+    }
+}
+
+TEST(TestAnimationTrack, TestAddFrames) {
+    AnimationTrack track;
+    track.OnHeader({"a", "b"}, {"joy"});
+    track.OnFrames({makeFrame(0.0, {0.1f, 0.2f}, {0.5f}), makeFrame(1.0 / 30, {0.3f, 0.4f})});
+
+    ASSERT_EQ(track.GetFramesCount(), 2);
+    EXPECT_EQ(track.GetBlendshapeCount(), 2);
+    EXPECT_EQ(track.GetEmotionCount(), 1);
+    EXPECT_EQ(track.GetBlendshapeNames(), std::vector<std::string>({"a", "b"}));
+    EXPECT_DOUBLE_EQ(track.GetTimestamp(1), 1.0 / 30);
+    EXPECT_EQ(track.GetBlendshapeWeights(1), std::vector<float>({0.3f, 0.4f}));
+    EXPECT_EQ(track.GetEmotionState(0), std::vector<float>({0.5f}));
+    // a frame without emotions keeps none
+    EXPECT_FALSE(track.HasEmotionState(1));
+    EXPECT_EQ(track.GetEmotionRow(1), nullptr);
+    EXPECT_TRUE(track.GetEmotionState(1).empty());
+
+    // rows are contiguous
+    EXPECT_EQ(track.GetBlendshapeRow(1), track.GetBlendshapeRow(0) + 2);
+
+    AnimDataFrame frame = track.GetFrame(0);
+    EXPECT_EQ(frame.blend_shape_names, track.GetBlendshapeNames());
+    EXPECT_EQ(frame.emotion_state_names, std::vector<std::string>({"joy"}));
+    EXPECT_EQ(frame.blend_shape_weights, std::vector<float>({0.1f, 0.2f}));
+    EXPECT_DOUBLE_EQ(track.GetFrame(5).timestamp, 0.0);
+}
+
+TEST(TestAnimationTrack, TestWidenRows) {
+    AnimationTrack track;
+    track.AddFrame(makeFrame(0.0, {}));
+    track.AddFrame(makeFrame(0.1, {0.1f}));
+    track.AddFrame(makeFrame(0.2, {0.2f, 0.3f, 0.4f}));
+
+    EXPECT_EQ(track.GetBlendshapeCount(), 3);
+    EXPECT_TRUE(track.GetBlendshapeWeights(0).empty());
+    EXPECT_EQ(track.GetBlendshapeWeights(1), std::vector<float>({0.1f, 0.0f, 0.0f}));
+    EXPECT_EQ(track.GetBlendshapeWeights(2), std::vector<float>({0.2f, 0.3f, 0.4f}));
+}
+
+TEST(TestAnimationTrack, TestEditFrames) {
+    AnimationTrack track;
+    for (int i = 0; i < 5; ++i) {
+        track.AddFrame(makeFrame(i, {static_cast<float>(i)}));
+    }
+
+    EXPECT_EQ(track.RemoveFrames(1, 3), 2);
+    EXPECT_EQ(track.RemoveFrames(3, 10), 0);
+    ASSERT_EQ(track.GetFramesCount(), 3);
+    EXPECT_EQ(track.GetBlendshapeWeights(1), std::vector<float>({3.0f}));
+
+    EXPECT_TRUE(track.InsertFrame(1, makeFrame(1, {1.0f})));
+    EXPECT_FALSE(track.InsertFrame(10, makeFrame(1, {1.0f})));
+    EXPECT_TRUE(track.ReplaceFrame(3, makeFrame(4, {40.0f})));
+    EXPECT_FALSE(track.ReplaceFrame(4, makeFrame(4, {40.0f})));
+
+    std::vector<float> expected = {0.0f, 1.0f, 3.0f, 40.0f};
+    ASSERT_EQ(track.GetFramesCount(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(track.GetBlendshapeWeights(i)[0], expected[i]);
+    }
+
+    track.Clear();
+    EXPECT_EQ(track.GetFramesCount(), 0);
+    EXPECT_EQ(track.GetBlendshapeCount(), 0);
+}
+
+TEST(TestAnimationTrack, TestTimeIndex) {
+    AnimationTrack track;
+    track.AddFrame(makeFrame(0.0, {0.0f}));
+    EXPECT_FALSE(track.HasTimeIndex());
+
+    // evenly spaced at 60 fps
+    for (int i = 1; i < 120; ++i) {
+        track.AddFrame(makeFrame(i / 60.0, {static_cast<float>(i)}));
+    }
+    ASSERT_TRUE(track.HasTimeIndex());
+    EXPECT_TRUE(track.HasUniformSpacing());
+    EXPECT_NEAR(track.GetFrameInterval(), 1.0 / 60, 1e-12);
+    EXPECT_NEAR(track.GetFramePosition(0.5), 30.0, 1e-9);
+    EXPECT_NEAR(track.GetFramePosition(0.5 + 1.0 / 120), 30.5, 1e-9);
+    EXPECT_NEAR(track.GetFramePosition(-1.0 / 60), -1.0, 1e-9);
+    EXPECT_NEAR(track.GetFramePosition(3.0), 180.0, 1e-9);
+
+    // an irregular frame falls back to the binary search with the same results
+    track.ReplaceFrame(60, makeFrame(60.3 / 60.0, {60.0f}));
+    ASSERT_TRUE(track.HasTimeIndex());
+    EXPECT_FALSE(track.HasUniformSpacing());
+    EXPECT_NEAR(track.GetFramePosition(0.5), 30.0, 1e-9);
+    EXPECT_NEAR(track.GetFramePosition(60.3 / 60.0), 60.0, 1e-9);
+    EXPECT_NEAR(track.GetFramePosition(60.0 / 60.0), 59.0 + 1.0 / 1.3, 1e-9);
+
+    track.ReplaceFrame(60, makeFrame(1.0, {60.0f}));
+    EXPECT_TRUE(track.HasUniformSpacing());
+
+    // timestamps that do not increase cannot be indexed
+    track.AddFrame(makeFrame(0.0, {0.0f}));
+    EXPECT_FALSE(track.HasTimeIndex());
+    track.RemoveFrames(120, 121);
+    EXPECT_TRUE(track.HasTimeIndex());
+    track.Clear();
+    EXPECT_FALSE(track.HasTimeIndex());
+}
+
+TEST(TestAnimationTrack, TestMemoryUsage) {
+    // 10 minutes at 30 fps with the names of the A2F output
+    const size_t NUM_FRAMES = 18000;
+    std::vector<std::string> blendshapeNames;
+    for (int i = 0; i < 52; ++i) {
+        blendshapeNames.push_back("blendshape_name_" + std::to_string(i));
+    }
+    std::vector<std::string> emotionNames(10, "emotion_name");
+
+    AnimationTrack track;
+    track.Reserve(NUM_FRAMES);
+    track.OnHeader(blendshapeNames, emotionNames);
+    size_t frameBytes = 0;
+    for (size_t i = 0; i < NUM_FRAMES; ++i) {
+        AnimDataFrame frame = makeFrame(i / 30.0, std::vector<float>(52, 0.5f), std::vector<float>(10, 0.1f));
+        track.AddFrame(frame);
+
+        // what the same frame takes in a std::vector<AnimDataFrame>
+        frame.blend_shape_names = blendshapeNames;
+        frame.emotion_state_names = emotionNames;
+        frameBytes += sizeof(AnimDataFrame) + (52 + 10) * (sizeof(float) + sizeof(std::string));
+        for (auto const &name : blendshapeNames) {
+            frameBytes += name.capacity();
+        }
+    }
+
+    std::cout << "Memory: " << track.GetMemoryUsage() << " bytes (AnimationTrack), "
+        << frameBytes << " bytes (std::vector<AnimDataFrame>)" << std::endl;
+    EXPECT_LT(track.GetMemoryUsage() * 10, frameBytes);
+}
+
+TEST(TestAnimationTrack, TestPublishedTrack) {
+    mace::PublishedTrack published;
+    EXPECT_EQ(published.Get()->GetFramesCount(), 0);
+    EXPECT_EQ(published.GetPublishedTime(), 0);
+
+    auto first = std::make_shared<AnimationTrack>();
+    first->AddFrame(makeFrame(0.0, {1.0f}));
+    published.Publish(first, 10);
+    EXPECT_EQ(published.Get(), first);
+    EXPECT_EQ(published.GetPublishedTime(), 10);
+
+    // an edit publishes a copy and leaves the held version alone
+    std::shared_ptr<const AnimationTrack> held = published.Get();
+    EXPECT_TRUE(published.Edit([](AnimationTrack &track) {
+        track.AddFrame(makeFrame(1.0 / 30, {2.0f}));
+        return true;
+    }, 20));
+    EXPECT_FALSE(published.Edit([](AnimationTrack &) { return false; }, 30));
+    EXPECT_EQ(held->GetFramesCount(), 1);
+    EXPECT_EQ(published.Get()->GetFramesCount(), 2);
+    EXPECT_EQ(published.GetPublishedTime(), 20);
+
+    // without readers, replaced versions are released at once
+    EXPECT_EQ(published.GetRetiredCount(), 0);
+    EXPECT_EQ(first.use_count(), 2);
+
+    mace::PublishedTrack copy(published);
+    EXPECT_EQ(copy.Get(), published.Get());
+    EXPECT_EQ(copy.GetPublishedTime(), 20);
+}
+
+TEST(TestAnimationTrack, TestPublishedTrackConcurrent) {
+    mace::PublishedTrack published;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> unexpected(0);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&] {
+            size_t last = 0;
+            while (!done) {
+                // versions only grow, and every version is complete
+                std::shared_ptr<const AnimationTrack> track = published.Get();
+                size_t count = track->GetFramesCount();
+                if (count < last || (count > 0 && track->GetBlendshapeView(count - 1)[0] != count)) {
+                    unexpected++;
+                }
+                last = count;
+            }
+        });
+    }
+    auto track = std::make_shared<AnimationTrack>();
+    for (size_t i = 1; i <= 500; ++i) {
+        track = std::make_shared<AnimationTrack>(*track);
+        track->AddFrame(makeFrame(i / 30.0, {static_cast<float>(i)}));
+        published.Publish(track, i);
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(unexpected, 0);
+    EXPECT_EQ(published.Get()->GetFramesCount(), 500);
+
+    // left over versions go with the next publish without readers
+    published.Publish(track, 501);
+    EXPECT_EQ(published.GetRetiredCount(), 0);
+}
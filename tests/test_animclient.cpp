@@ -18,19 +18,24 @@
 // LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <vector>
 #include <optional>
+#include <stdexcept>
+#include <thread>
 
 #include "aceclient/animation.h"
 #include "aceclient/frame_receiver.h"
 #include "aceclient/audio.h"
 #include "aceclient/logger.h"
 #include "aceclient/parameters.h"
+#include "utils.h"
 
 #include <gtest/gtest.h>
 
@@ -50,8 +55,7 @@ class StubAnimationClient : public mace::AnimationClient {
     using AnimationClient::_functionId;
 
     using AnimationClient::framerate;
-    using AnimationClient::lastUpdated;
-    using AnimationClient::frames;
+    using AnimationClient::track;
     using AnimationClient::faceParameters;
     using AnimationClient::emotionState;
     using AnimationClient::emotionParameters;
@@ -238,6 +242,131 @@ TEST(TestClient, TestGetBlendshapes) {
     ASSERT_EQ(client.GetBlendshapeWeights(0.01f), expected);
 }
 
+TEST(TestClient, TestFrameViews) {
+    mace::AnimationClient client;
+    EXPECT_TRUE(client.GetBlendshapeWeightsView(0).empty());
+    EXPECT_TRUE(client.GetBlendshapeNamesView().empty());
+
+    AnimDataFrame frame1;
+    frame1.blend_shape_names = {"a", "b"};
+    frame1.blend_shape_weights = {0.0, 0.0};
+    frame1.emotion_state_names = {"joy"};
+    frame1.emotion_state = {0.5};
+    AnimDataFrame frame2;
+    frame2.blend_shape_names = {"a", "b"};
+    frame2.blend_shape_weights = {0.1, 0.2};
+    frame2.emotion_state_names = {"joy"};
+    frame2.emotion_state = {0.7};
+    client.AddFrame(frame1);
+    client.AddFrame(frame2);
+
+    mace::ArrayView<const float> weights = client.GetBlendshapeWeightsView(1);
+    ASSERT_EQ(weights.ToVector(), frame2.blend_shape_weights);
+    EXPECT_EQ(client.GetBlendshapeWeightsView(5).ToVector(), frame2.blend_shape_weights);
+    EXPECT_EQ(client.GetBlendshapeWeightsView(2, mace::Cycle).ToVector(), frame1.blend_shape_weights);
+    EXPECT_EQ(client.GetEmotionStateView(1).ToVector(), frame2.emotion_state);
+    EXPECT_EQ(client.GetBlendshapeNamesView().ToVector(), frame1.blend_shape_names);
+    EXPECT_EQ(client.GetEmotionStateNamesView().ToVector(), frame1.emotion_state_names);
+
+    // caller buffers
+    float buffer[4] = {-1.0f, -1.0f, -1.0f, -1.0f};
+    EXPECT_EQ(client.GetBlendshapeWeights((size_t)1, buffer, 1), 2);
+    EXPECT_EQ(buffer[0], -1.0f);  // too small, untouched
+    EXPECT_EQ(client.GetBlendshapeWeights((size_t)1, buffer, 4), 2);
+    EXPECT_EQ(std::vector<float>(buffer, buffer + 2), frame2.blend_shape_weights);
+    EXPECT_EQ(client.GetEmotionState((size_t)0, buffer, 4), 1);
+    EXPECT_EQ(buffer[0], 0.5f);
+    EXPECT_EQ(client.GetBlendshapeWeights(0.01f, buffer, 4), 2);
+    EXPECT_EQ(std::vector<float>(buffer, buffer + 2), client.GetBlendshapeWeights(0.01f));
+    EXPECT_EQ(client.GetEmotionState(1.0f / 60, buffer, 4), 1);
+    EXPECT_NEAR(buffer[0], 0.6f, 1e-6f);
+
+    // reading frames does not allocate
+    size_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (size_t i = 0; i < 100; ++i) {
+            weights = client.GetBlendshapeWeightsView(i % 2);
+            client.GetEmotionStateView(i % 2);
+            client.GetBlendshapeNamesView();
+            client.GetBlendshapeWeights(i * 0.005f, buffer, 4);
+        }
+        allocations = counter.GetCount();
+    }
+    EXPECT_EQ(allocations, 0);
+}
+
+TEST(TestClient, TestSampleRange) {
+    mace::AnimationClient client;
+    mace::SampledRange range;
+    EXPECT_EQ(client.SampleRange(0.0f, 1.0f, 0.0f, mace::Constant, &range), AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_EQ(client.SampleRange(1.0f, 0.0f, 30.0f, mace::Constant, &range), AceClientStatus::ERROR_INVALID_INPUT);
+    ASSERT_EQ(client.SampleRange(0.0f, 1.0f, 30.0f, mace::Constant, &range), AceClientStatus::OK);
+    EXPECT_EQ(range.frames, 31);
+    EXPECT_EQ(range.channels, 0);
+
+    for (int i = 0; i < 10; ++i) {
+        AnimDataFrame frame;
+        frame.blend_shape_names = {"a", "b"};
+        frame.blend_shape_weights = {static_cast<float>(i), static_cast<float>(2 * i)};
+        client.AddFrame(frame);
+    }
+
+    // on the frames
+    ASSERT_EQ(client.SampleRange(0.0f, 9.0f / 30, 30.0f, mace::Constant, &range), AceClientStatus::OK);
+    ASSERT_EQ(range.frames, 10);
+    ASSERT_EQ(range.channels, 2);
+    ASSERT_EQ(range.values.size(), 20);
+    for (size_t i = 0; i < range.frames; ++i) {
+        EXPECT_NEAR(range.values[i * 2], i, 1e-4f);
+        EXPECT_NEAR(range.values[i * 2 + 1], 2 * i, 1e-4f);
+    }
+
+    // between the frames, and past the end
+    ASSERT_EQ(client.SampleRange(0.0f, 0.5f, 60.0f, mace::Constant, &range), AceClientStatus::OK);
+    ASSERT_EQ(range.frames, 31);
+    EXPECT_NEAR(range.values[1 * 2], 0.5f, 1e-4f);
+    EXPECT_NEAR(range.values[30 * 2], 9.0f, 1e-4f);
+    ASSERT_EQ(client.SampleRange(10.0f / 30, 11.0f / 30, 30.0f, mace::Cycle, &range), AceClientStatus::OK);
+    ASSERT_EQ(range.frames, 2);
+    EXPECT_NEAR(range.values[0], 0.0f, 1e-4f);
+    EXPECT_NEAR(range.values[2], 1.0f, 1e-4f);
+
+    // the blocks sampled in parallel match the serial pass
+    mace::SampledRange serial;
+    ASSERT_EQ(client.SampleRange(0.0f, 10.0f, 240.0f, mace::Cycle, &serial), AceClientStatus::OK);
+    ASSERT_EQ(client.SampleRange(0.0f, 10.0f, 240.0f, mace::Cycle, &range, 4), AceClientStatus::OK);
+    EXPECT_EQ(range.frames, 2401);
+    EXPECT_EQ(range.values, serial.values);
+}
+
+TEST(TestClient, TestFrameIndexByTimestamps) {
+    StubAnimationClient client;
+    // 60 fps from the server, while the client defaults to 30
+    for (int i = 0; i < 60; ++i) {
+        AnimDataFrame frame;
+        frame.blend_shape_names = {"a"};
+        frame.blend_shape_weights = {static_cast<float>(i)};
+        frame.timestamp = i / 60.0;
+        client.AddFrame(frame);
+    }
+
+    EXPECT_EQ(client.GetFrameIndex(0.0f), 0);
+    EXPECT_EQ(client.GetFrameIndex(0.5f), 30);
+    EXPECT_EQ(client.GetFrameIndex(0.5f + 0.25f / 60), 31);  // ceil
+    EXPECT_EQ(client.GetFrameIndex(-1.0f), 0);
+    EXPECT_NEAR(client.GetAnimationLength(), 1.0f, 1e-6f);
+    EXPECT_TRUE(client.HasAnimation(0.98f));
+    EXPECT_FALSE(client.HasAnimation(1.0f));
+    EXPECT_NEAR(client.GetBlendshapeWeights(0.5f + 0.5f / 60)[0], 30.5f, 1e-4f);
+
+    // cycling takes constant time for any index
+    EXPECT_EQ(client.getValidFrameIndex(61, mace::Cycle), 1);
+    EXPECT_EQ(client.getValidFrameIndex(1000000000000003, mace::Cycle), 1000000000000003 % 60);
+    EXPECT_EQ(client.getValidFrameIndex(61, mace::Constant), 59);
+    EXPECT_NEAR(client.GetBlendshapeWeights(1.5f, mace::Cycle)[0], 30.0f, 1e-4f);
+}
+
 TEST(TestClient, TestFrameAccesses) {
     mace::AnimationClient client;
     /*
@@ -433,3 +562,470 @@ TEST(TestClient, TestRequestAnimation2) {
       ASSERT_EQ(52, frame.blend_shape_weights.size());
     }
 }
+
+class FlakyAnimationClient : public mace::AnimationClient {
+    // breaks the stream of the first attempt after 30 frames
+    public:
+    std::vector<size_t> sentSampleCounts;
+
+    protected:
+    AceClientStatus requestAnimation(mace::AudioSource const &audio, mace::FrameReceiver *receiver) override {
+        size_t sample_count = audio.GetSampleCount();
+        sentSampleCounts.push_back(sample_count);
+        receiver->OnHeader({"a", "b"}, {});
+        size_t frameCount = (sample_count * mace::DEFAULT_FRAMERATE + DefaultSampleRate - 1) / DefaultSampleRate;
+        if (sentSampleCounts.size() == 1) {
+            frameCount = 30;
+        }
+        for (size_t i = 0; i < frameCount; ++i) {
+            std::vector<AnimDataFrame> frame(1);
+            frame[0].timestamp = static_cast<double>(i) / mace::DEFAULT_FRAMERATE;
+            frame[0].blend_shape_weights = {0.0f, 1.0f};
+            receiver->OnFrames(std::move(frame));
+        }
+        return sentSampleCounts.size() == 1 ? AceClientStatus::ERROR_CONNECTION : AceClientStatus::OK;
+    }
+};
+
+TEST(TestClient, TestResumeRequest) {
+    FlakyAnimationClient animclient;
+    mace::RetryPolicy policy;
+    policy.initialBackoffMs = 1;
+    policy.prerollSeconds = 0.5;
+    animclient.SetRetryPolicy(policy);
+
+    std::vector<int16_t> samples(DefaultSampleRate * 3, 0);
+    std::vector<AnimDataFrame> frames;
+    AceClientStatus result = animclient.RequestAnimation(samples, &frames);
+
+    ASSERT_EQ(result, AceClientStatus::OK);
+    ASSERT_EQ(animclient.sentSampleCounts.size(), 2);
+    // the last frame was at 29/30s, so the audio is resent from 14/30s
+    EXPECT_EQ(animclient.sentSampleCounts[1], samples.size() - std::llround(14.0 / 30 * DefaultSampleRate));
+    ASSERT_EQ(frames.size(), 90);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_NEAR(frames[i].timestamp, i / 30.0, 1e-3);
+    }
+}
+
+TEST(TestClient, TestResumeDisabled) {
+    FlakyAnimationClient animclient;
+    mace::RetryPolicy policy;
+    policy.maxRetries = 0;
+    animclient.SetRetryPolicy(policy);
+
+    std::vector<int16_t> samples(DefaultSampleRate * 3, 0);
+    std::vector<AnimDataFrame> frames;
+    AceClientStatus result = animclient.RequestAnimation(samples, &frames);
+
+    EXPECT_EQ(result, AceClientStatus::ERROR_CONNECTION);
+    EXPECT_EQ(animclient.sentSampleCounts.size(), 1);
+    EXPECT_EQ(frames.size(), 30);
+}
+
+class CountingAnimationClient : public mace::AnimationClient {
+    // answers every request with a frame per 1/30s without a server
+    public:
+    size_t requestCount = 0;
+
+    void SetKeyVersion(uint32_t version) {
+        requestKeyVersion = version;
+    }
+
+    protected:
+    AceClientStatus requestAnimation(mace::AudioSource const &audio, mace::FrameReceiver *receiver) override {
+        size_t sample_count = audio.GetSampleCount();
+        requestCount++;
+        receiver->OnHeader({"a", "b"}, {});
+        std::vector<AnimDataFrame> frames(sample_count * mace::DEFAULT_FRAMERATE / DefaultSampleRate);
+        for (size_t i = 0; i < frames.size(); ++i) {
+            frames[i].timestamp = static_cast<double>(i) / mace::DEFAULT_FRAMERATE;
+            frames[i].blend_shape_weights = {static_cast<float>(i), 1.0f};
+        }
+        receiver->OnFrames(std::move(frames));
+        return AceClientStatus::OK;
+    }
+};
+
+TEST(TestClient, TestRequestKey) {
+    mace::AnimationClient client;
+    std::vector<int16_t> samples(1600, 1);
+    mace::RequestKey key = client.GetRequestKey(samples.data(), samples.size());
+    EXPECT_EQ(client.GetRequestKey(samples.data(), samples.size()), key);
+
+    samples[10] = 2;
+    EXPECT_NE(client.GetRequestKey(samples.data(), samples.size()).audio, key.audio);
+    samples[10] = 1;
+
+    // the order the parameters are set in does not matter
+    mace::AnimationClient other;
+    client.SetBlendshapeMultiplier("a", 1.5f);
+    client.SetBlendshapeMultiplier("b", 0.5f);
+    other.SetBlendshapeMultiplier("b", 0.5f);
+    other.SetBlendshapeMultiplier("a", 1.5f);
+    EXPECT_NE(client.GetRequestKey(samples.data(), samples.size()), key);
+    EXPECT_EQ(client.GetRequestKey(samples.data(), samples.size()), other.GetRequestKey(samples.data(), samples.size()));
+
+    mace::AceEmotionState emotions;
+    emotions.joy = 1.0f;
+    other.SetEmotionState(emotions);
+    EXPECT_NE(client.GetRequestKey(samples.data(), samples.size()), other.GetRequestKey(samples.data(), samples.size()));
+    other.SetFunctionId("another-function");
+    EXPECT_NE(client.GetRequestKey(samples.data(), samples.size()).parameters, key.parameters);
+
+    // the endpoint is part of the key, the credentials are not
+    mace::AnimationClient local;
+    mace::AnimationClient remote;
+    remote.SetUrl("http://example.invalid:52000");
+    EXPECT_NE(local.GetRequestKey(samples.data(), samples.size()), remote.GetRequestKey(samples.data(), samples.size()));
+    local.SetAPIKey("another-key");
+    EXPECT_EQ(local.GetRequestKey(samples.data(), samples.size()), mace::AnimationClient().GetRequestKey(samples.data(), samples.size()));
+}
+
+TEST(TestClient, TestDiskCache) {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "mace_test_client_cache";
+    std::filesystem::remove_all(directory);
+    auto cache = std::make_shared<mace::DiskCache>(directory.u8string());
+    std::vector<int16_t> samples(DefaultSampleRate, 0);
+
+    CountingAnimationClient client;
+    client.SetDiskCache(cache);
+    ASSERT_EQ(client.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(client.requestCount, 1);
+    EXPECT_EQ(cache->GetStats().stores, 1);
+
+    // another client with the same audio and parameters loads the clip
+    CountingAnimationClient other;
+    other.SetDiskCache(cache);
+    ASSERT_EQ(other.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(other.requestCount, 0);
+    ASSERT_EQ(other.GetFramesCount(), client.GetFramesCount());
+    EXPECT_EQ(other.GetBlendshapeNames(), client.GetBlendshapeNames());
+    EXPECT_EQ(other.GetBlendshapeWeights((size_t)20), client.GetBlendshapeWeights((size_t)20));
+
+    // other parameters are requested again
+    other.SetBlendshapeOffset("a", 0.1f);
+    ASSERT_EQ(other.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(other.requestCount, 1);
+    EXPECT_EQ(cache->GetStats().hits, 1);
+
+    // a build with another key format does not load the clips of this one
+    CountingAnimationClient newer;
+    newer.SetDiskCache(cache);
+    newer.SetKeyVersion(mace::REQUEST_KEY_VERSION + 1);
+    EXPECT_NE(newer.GetRequestKey(samples.data(), samples.size()), client.GetRequestKey(samples.data(), samples.size()));
+    ASSERT_EQ(newer.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(newer.requestCount, 1);
+    EXPECT_EQ(cache->GetStats().hits, 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(TestClient, TestClipCache) {
+    mace::ClipCache::Instance().Clear();
+    mace::ClipCache::Instance().ResetStats();
+    std::vector<int16_t> samples(DefaultSampleRate, 3);
+
+    CountingAnimationClient client;
+    CountingAnimationClient other;
+    client.SetUseClipCache(true);
+    other.SetUseClipCache(true);
+    ASSERT_EQ(client.UpdateAnimation(samples), AceClientStatus::OK);
+    ASSERT_EQ(other.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(client.requestCount, 1);
+    EXPECT_EQ(other.requestCount, 0);
+
+    // both play the same frames
+    EXPECT_EQ(other.GetBlendshapeWeightsView(5).data(), client.GetBlendshapeWeightsView(5).data());
+    mace::ClipCacheStats stats = mace::ClipCache::Instance().GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.clips, 1);
+    EXPECT_GT(stats.bytes, 0);
+
+    // editing copies the shared frames first
+    AnimDataFrame frame;
+    frame.blend_shape_weights = {100.0f, 100.0f};
+    other.ReplaceFrame(5, frame);
+    EXPECT_EQ(other.GetBlendshapeWeights((size_t)5)[0], 100.0f);
+    EXPECT_EQ(client.GetBlendshapeWeights((size_t)5)[0], 5.0f);
+
+    // the budget evicts; clients keep their frames
+    mace::ClipCache::Instance().SetBudget(0);
+    EXPECT_EQ(mace::ClipCache::Instance().GetStats().clips, 0);
+    EXPECT_EQ(mace::ClipCache::Instance().GetStats().evictions, 1);
+    EXPECT_EQ(client.GetFramesCount(), 30);
+    ASSERT_EQ(other.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(other.requestCount, 1);
+
+    mace::ClipCache::Instance().SetBudget(mace::DEFAULT_CLIP_CACHE_BUDGET);
+    mace::ClipCache::Instance().Clear();
+}
+
+TEST(TestClient, TestRequestAnimationFromFile) {
+    mace::WavFileAudioSource wav;
+    ASSERT_EQ(wav.Open(test_audio_path), AceClientStatus::OK);
+    std::vector<int16_t> samples = get_file_wav_content_int16(test_audio_path);
+
+    // a file and its samples in memory are the same request
+    CountingAnimationClient client;
+    client.SetUseClipCache(true);
+    mace::ClipCache::Instance().Clear();
+    EXPECT_EQ(client.GetRequestKey(wav), client.GetRequestKey(samples.data(), samples.size()));
+    ASSERT_EQ(client.UpdateAnimation(wav), AceClientStatus::OK);
+    EXPECT_EQ(client.GetFramesCount(), samples.size() * mace::DEFAULT_FRAMERATE / DefaultSampleRate);
+    ASSERT_EQ(client.UpdateAnimation(samples), AceClientStatus::OK);
+    EXPECT_EQ(client.requestCount, 1);
+    mace::ClipCache::Instance().Clear();
+
+    // the service only accepts 16kHz
+    mace::MemoryAudioSource audio48k(samples.data(), samples.size(), 48000);
+    std::vector<AnimDataFrame> frames;
+    mace::FrameCollector collector(&frames);
+    EXPECT_EQ(client.RequestAnimation(audio48k, &collector), AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_EQ(client.requestCount, 1);
+}
+
+class GatedAnimationClient : public CountingAnimationClient {
+    // holds every request until the gate opens, then answers with the given status
+    public:
+    std::shared_future<AceClientStatus> gate;
+    bool throwOnOpen = false;
+
+    GatedAnimationClient() {
+        SetCoalesceRequests(true);
+    }
+
+    protected:
+    AceClientStatus requestAnimation(mace::AudioSource const &audio, mace::FrameReceiver *receiver) override {
+        AceClientStatus status = gate.get();
+        if (throwOnOpen) {
+            throw std::runtime_error("failed while streaming");
+        }
+        if (status != AceClientStatus::OK) {
+            requestCount++;
+            return status;
+        }
+        return CountingAnimationClient::requestAnimation(audio, receiver);
+    }
+};
+
+namespace {
+    void waitForFollowers(size_t count) {
+        while (mace::RequestCoalescer::Instance().GetStats().followers < count) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+TEST(TestClient, TestCoalesceRequests) {
+    mace::RequestCoalescer::Instance().ResetStats();
+    std::vector<int16_t> samples(DefaultSampleRate, 4);
+    std::promise<AceClientStatus> open;
+    std::shared_future<AceClientStatus> gate = open.get_future().share();
+
+    GatedAnimationClient clients[3];
+    for (auto &client : clients) {
+        client.gate = gate;
+    }
+    std::vector<AnimDataFrame> frames[3];
+    std::future<AceClientStatus> results[3];
+    results[0] = std::async(std::launch::async, [&] { return clients[0].RequestAnimation(samples, &frames[0]); });
+    while (mace::RequestCoalescer::Instance().GetStats().inFlight < 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (int i = 1; i < 3; ++i) {
+        results[i] = std::async(std::launch::async, [&, i] { return clients[i].RequestAnimation(samples, &frames[i]); });
+    }
+    waitForFollowers(2);
+    open.set_value(AceClientStatus::OK);
+
+    // one request went to the server and every caller received its frames
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(results[i].get(), AceClientStatus::OK);
+        ASSERT_EQ(frames[i].size(), 30);
+        EXPECT_EQ(frames[i][7].blend_shape_weights, frames[0][7].blend_shape_weights);
+        EXPECT_EQ(frames[i][7].blend_shape_names, frames[0][7].blend_shape_names);
+    }
+    EXPECT_EQ(clients[0].requestCount + clients[1].requestCount + clients[2].requestCount, 1);
+    mace::RequestCoalescerStats stats = mace::RequestCoalescer::Instance().GetStats();
+    EXPECT_EQ(stats.leaders, 1);
+    EXPECT_EQ(stats.followers, 2);
+    EXPECT_EQ(stats.inFlight, 0);
+
+    // a later request is not coalesced with a completed one
+    std::vector<AnimDataFrame> later;
+    EXPECT_EQ(clients[1].RequestAnimation(samples, &later), AceClientStatus::OK);
+    EXPECT_EQ(clients[1].requestCount, 1);
+}
+
+TEST(TestClient, TestCoalesceRequestsError) {
+    mace::RequestCoalescer::Instance().ResetStats();
+    std::vector<int16_t> samples(DefaultSampleRate, 5);
+    std::promise<AceClientStatus> open;
+    std::shared_future<AceClientStatus> gate = open.get_future().share();
+
+    GatedAnimationClient leader;
+    GatedAnimationClient follower;
+    GatedAnimationClient uncoalesced;
+    leader.gate = follower.gate = uncoalesced.gate = gate;
+    uncoalesced.SetCoalesceRequests(false);
+
+    std::vector<AnimDataFrame> frames[3];
+    auto first = std::async(std::launch::async, [&] { return leader.RequestAnimation(samples, &frames[0]); });
+    while (mace::RequestCoalescer::Instance().GetStats().inFlight < 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto second = std::async(std::launch::async, [&] { return follower.RequestAnimation(samples, &frames[1]); });
+    auto third = std::async(std::launch::async, [&] { return uncoalesced.RequestAnimation(samples, &frames[2]); });
+    waitForFollowers(1);
+    open.set_value(AceClientStatus::ERROR_UNAUTHENTICATED);
+
+    // the waiter shares the error
+    EXPECT_EQ(first.get(), AceClientStatus::ERROR_UNAUTHENTICATED);
+    EXPECT_EQ(second.get(), AceClientStatus::ERROR_UNAUTHENTICATED);
+    EXPECT_EQ(third.get(), AceClientStatus::ERROR_UNAUTHENTICATED);
+    EXPECT_TRUE(frames[1].empty());
+    EXPECT_EQ(leader.requestCount, 1);
+    EXPECT_EQ(follower.requestCount, 0);
+    EXPECT_EQ(uncoalesced.requestCount, 1);
+}
+
+TEST(TestClient, TestCoalesceUpdates) {
+    // configured like the AceAnimationPlayer node: players triggered together all miss the clip
+    // cache, and only the first one streams
+    mace::RequestCoalescer::Instance().ResetStats();
+    mace::ClipCache::Instance().Clear();
+    std::vector<int16_t> samples(DefaultSampleRate, 5);
+    std::promise<AceClientStatus> open;
+    std::shared_future<AceClientStatus> gate = open.get_future().share();
+
+    GatedAnimationClient players[2];
+    for (auto &player : players) {
+        player.gate = gate;
+        player.SetUseClipCache(true);
+        player.SetCoalesceRequests(true);
+    }
+    auto first = std::async(std::launch::async, [&] { return players[0].UpdateAnimation(samples); });
+    while (mace::RequestCoalescer::Instance().GetStats().inFlight < 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto second = std::async(std::launch::async, [&] { return players[1].UpdateAnimation(samples); });
+    waitForFollowers(1);
+    open.set_value(AceClientStatus::OK);
+
+    EXPECT_EQ(first.get(), AceClientStatus::OK);
+    EXPECT_EQ(second.get(), AceClientStatus::OK);
+    EXPECT_EQ(players[0].requestCount + players[1].requestCount, 1);
+    EXPECT_EQ(players[0].GetFramesCount(), 30);
+    EXPECT_EQ(players[1].GetFramesCount(), 30);
+    mace::ClipCache::Instance().Clear();
+}
+
+TEST(TestClient, TestCoalesceRequestsLeaderThrows) {
+    mace::RequestCoalescer::Instance().ResetStats();
+    EXPECT_FALSE(mace::AnimationClient().GetCoalesceRequests());
+    std::vector<int16_t> samples(DefaultSampleRate, 9);
+    std::promise<AceClientStatus> open;
+    std::shared_future<AceClientStatus> gate = open.get_future().share();
+
+    GatedAnimationClient leader;
+    GatedAnimationClient follower;
+    leader.gate = follower.gate = gate;
+    leader.throwOnOpen = true;
+    std::vector<AnimDataFrame> frames[2];
+    auto first = std::async(std::launch::async, [&] { return leader.RequestAnimation(samples, &frames[0]); });
+    while (mace::RequestCoalescer::Instance().GetStats().inFlight < 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto second = std::async(std::launch::async, [&] { return follower.RequestAnimation(samples, &frames[1]); });
+    waitForFollowers(1);
+    open.set_value(AceClientStatus::OK);
+
+    // the waiter is released with an error, and a later request starts over
+    EXPECT_THROW(first.get(), std::runtime_error);
+    EXPECT_EQ(second.get(), AceClientStatus::ERROR_UNKNOWN);
+    EXPECT_EQ(mace::RequestCoalescer::Instance().GetStats().inFlight, 0);
+    EXPECT_EQ(follower.RequestAnimation(samples, &frames[1]), AceClientStatus::OK);
+    EXPECT_EQ(follower.requestCount, 1);
+}
+
+TEST(TestClient, TestUpdateAnimationDoubleBuffered) {
+    mace::RequestCoalescer::Instance().ResetStats();
+    std::promise<AceClientStatus> opened;
+    opened.set_value(AceClientStatus::OK);
+    GatedAnimationClient client;
+    client.gate = opened.get_future().share();
+    ASSERT_EQ(client.UpdateAnimation(std::vector<int16_t>(DefaultSampleRate, 6)), AceClientStatus::OK);
+    ASSERT_EQ(client.GetFramesCount(), 30);
+    long long updated = client.GetLastUpdated();
+    std::shared_ptr<const mace::AnimationTrack> held = client.GetTrack();
+
+    // readers see the previous animation, never a partial one, while the next is requested
+    std::promise<AceClientStatus> open;
+    client.gate = open.get_future().share();
+    std::atomic<bool> done(false);
+    std::atomic<size_t> unexpected(0);
+    std::thread reader([&] {
+        while (!done) {
+            size_t count = client.GetFramesCount();
+            if (count != 30 && count != 60) {
+                unexpected++;
+            }
+            client.GetBlendshapeWeights(0.5f);
+        }
+    });
+    std::vector<int16_t> longer(DefaultSampleRate * 2, 7);
+    auto result = std::async(std::launch::async, [&] { return client.UpdateAnimation(longer); });
+    while (mace::RequestCoalescer::Instance().GetStats().inFlight < 1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(client.GetFramesCount(), 30);
+    EXPECT_EQ(client.GetTrack(), held);
+    EXPECT_EQ(client.GetLastUpdated(), updated);
+    open.set_value(AceClientStatus::OK);
+    EXPECT_EQ(result.get(), AceClientStatus::OK);
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(unexpected, 0);
+    EXPECT_EQ(client.GetFramesCount(), 60);
+    EXPECT_GT(client.GetLastUpdated(), updated);
+    // the held version is unchanged
+    EXPECT_EQ(held->GetFramesCount(), 30);
+
+    // a failed update keeps the animation
+    std::promise<AceClientStatus> failed;
+    failed.set_value(AceClientStatus::ERROR_UNAUTHENTICATED);
+    client.gate = failed.get_future().share();
+    EXPECT_EQ(client.UpdateAnimation(std::vector<int16_t>(DefaultSampleRate, 8)), AceClientStatus::ERROR_UNAUTHENTICATED);
+    EXPECT_EQ(client.GetFramesCount(), 60);
+
+    // edits publish a copy
+    held = client.GetTrack();
+    AnimDataFrame frame;
+    frame.blend_shape_weights = {1.0f, 2.0f};
+    EXPECT_EQ(client.AddFrame(frame), 61);
+    EXPECT_EQ(held->GetFramesCount(), 60);
+    EXPECT_EQ(client.RemoveFrames(60, 61), 1);
+    EXPECT_EQ(client.GetFramesCount(), 60);
+}
+
+TEST(TestClient, TestRequestAnimationCompressed) {
+    /*Requires the mock server; see TestClient.TestRequestAnimation1.
+    */
+    mace::AnimationClient animclient;
+    animclient.SetUrl(test_url);
+    animclient.SetCompression(mace::CompressionGzip);
+    animclient.SetCompressionEstimate(1000);
+
+    std::vector<int16_t> samples(8320, 0);
+    std::vector<AnimDataFrame> frames;
+    ASSERT_EQ(animclient.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    ASSERT_GE(frames.size(), 1);
+
+    auto stats = animclient.GetLastRequestStats();
+    EXPECT_GT(stats.bytes_received, 0);
+    EXPECT_EQ(stats.sampled_bytes_sent, stats.bytes_sent);
+    EXPECT_LT(stats.compressed_bytes_sent, stats.bytes_sent);
+}
@@ -19,11 +19,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <filesystem>
 #include <numeric>
 
 #include "aceclient/audio.h"
+#include "aceclient/audio_source.h"
 
 #include <gtest/gtest.h>
 
@@ -43,6 +45,18 @@ TEST(TestAudio, TestGetSamplePosition) {
     ASSERT_EQ(get_sample_position(0.5f), 8000);
 }
 
+TEST(TestAudio, TestConvertFloatToInt16) {
+    // saturates at both ends instead of wrapping negative overflow
+    std::vector<float> input = {0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 1.5f, -1.5f};
+    std::vector<int16_t> expected = {0, 16384, -16384, 32767, -32768, 32767, -32768};
+    ASSERT_EQ(convert_float_to_int16(input), expected);
+
+    std::vector<float> back(expected.size());
+    convert_int16_to_float(expected.data(), back.data(), expected.size());
+    ASSERT_EQ(back[1], 0.5f);
+    ASSERT_EQ(back[4], -1.0f);
+}
+
 TEST(TestAudio, TestResample) {
     std::vector<float> source;
 
@@ -51,20 +65,53 @@ TEST(TestAudio, TestResample) {
         source.push_back((i % 10) / 10.0f);
     }
 
-    std::vector<float> resampled_03 = resample(source, 3, 10);
-    ASSERT_EQ(resampled_03.size(), 30);
-    ASSERT_EQ(resampled_03[2], 2.0f / 3.0f);
-    ASSERT_EQ(resampled_03[1], 1.0f / 3.0f);
+    // one output sample per position of the output rate within the input
+    ASSERT_EQ(resample(source, 3, 10).size(), 30);
+    ASSERT_EQ(resample(source, 10, 25).size(), 40);
+    ASSERT_EQ(resample(source, 5, 10).size(), 50);
+    ASSERT_EQ(resample(source, 16000, 44100).size(), 37);
+    ASSERT_EQ(resample(source, 20, 10).size(), 200);
+    ASSERT_EQ(resample(source, 10, 10), source);
+    ASSERT_TRUE(resample(source, 0, 10).empty());
+
+    // a constant signal stays constant away from the ends
+    std::vector<float> constant(1000, 0.5f);
+    std::vector<float> resampled = resample(constant, 16000, 44100);
+    for (size_t i = 100; i < resampled.size() - 100; i++) {
+        ASSERT_NEAR(resampled[i], 0.5f, 1e-4f) << i;
+    }
+}
 
-    std::vector<float> resampled_04 = resample(source, 10, 25);
-    ASSERT_EQ(resampled_04.size(), 40);
-    ASSERT_EQ(resampled_04[2], 0.5f);
-    ASSERT_EQ(resampled_04[1], 0.25f);
+TEST(TestAudio, TestResampleQuality) {
+    const size_t SOURCE_RATE = 44100;
+    const size_t TARGET_RATE = 16000;
+    const double PI = 3.14159265358979323846;
+    auto tone = [&](double frequency, size_t rate, size_t count) {
+        std::vector<float> samples(count);
+        for (size_t i = 0; i < count; i++) {
+            samples[i] = static_cast<float>(0.5 * std::sin(2.0 * PI * frequency * i / rate));
+        }
+        return samples;
+    };
+
+    // a tone in the passband is kept
+    std::vector<float> resampled = resample(tone(1000.0, SOURCE_RATE, SOURCE_RATE), TARGET_RATE, SOURCE_RATE);
+    std::vector<float> expected = tone(1000.0, TARGET_RATE, TARGET_RATE);
+    ASSERT_EQ(resampled.size(), TARGET_RATE);
+    double max_error = 0.0;
+    for (size_t i = 200; i < resampled.size() - 200; i++) {
+        max_error = std::max(max_error, std::abs(static_cast<double>(resampled[i]) - expected[i]));
+    }
+    EXPECT_LT(max_error, 1e-3);
 
-    std::vector<float> resampled_05 = resample(source, 5, 10);
-    ASSERT_EQ(resampled_05.size(), 50);
-    ASSERT_EQ(resampled_05[2], 0.4f);
-    ASSERT_EQ(resampled_05[1], 0.2f);
+    // a tone above the new Nyquist frequency is removed instead of aliased to 6kHz
+    resampled = resample(tone(10000.0, SOURCE_RATE, SOURCE_RATE), TARGET_RATE, SOURCE_RATE);
+    double power = 0.0;
+    for (size_t i = 200; i < resampled.size() - 200; i++) {
+        power += resampled[i] * resampled[i];
+    }
+    double rms = std::sqrt(power / (resampled.size() - 400));
+    EXPECT_LT(rms, 0.5 * 1e-3);  // -60dB
 }
 
 TEST(TestAudio, TestUpsample) {
@@ -257,3 +304,29 @@ TEST(TestAudio, TestReadWavFile48kInt16) {
     ASSERT_GE(max_val, 1);
     ASSERT_LE(min_val, -1);
 }
+
+TEST(TestAudio, TestReadWavFileInt16Direct) {
+    // PCM16 at the target rate is taken as stored
+    std::string input_path("./sample_data/audio_4sec_16k_s16le.wav");
+    mace::WavFileAudioSource wav;
+    ASSERT_EQ(wav.Open(input_path), AceClientStatus::OK);
+    ASSERT_NE(wav.GetSamples(), nullptr);
+    std::vector<int16_t> stored(wav.GetSamples(), wav.GetSamples() + wav.GetSampleCount());
+
+    std::vector<int16_t> samples = get_file_wav_content_int16(input_path);
+    EXPECT_EQ(samples, stored);
+    EXPECT_EQ(samples, convert_float_to_int16(get_file_wav_content(input_path)));
+
+    // resampled without a float copy of the file, close to the float path
+    input_path = "./sample_data/audio_6sec_48k_s16le.wav";
+    samples = get_file_wav_content_int16(input_path);
+    std::vector<int16_t> expected = convert_float_to_int16(get_file_wav_content(input_path));
+    ASSERT_EQ(samples.size(), expected.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        ASSERT_NEAR(samples[i], expected[i], 1) << "at " << i;
+    }
+
+    // no upsampling
+    EXPECT_TRUE(get_file_wav_content_int16(input_path, 96000).empty());
+    EXPECT_TRUE(get_file_wav_content_int16("./sample_data/missing.wav").empty());
+}
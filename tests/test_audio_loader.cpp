@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include <atomic>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "aceclient/audio_loader.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+    std::string const test_audio_path = "./sample_data/audio_4sec_16k_s16le.wav";
+    std::string const test_audio_48k_path = "./sample_data/audio_6sec_48k_s16le.wav";
+
+    // Occupies every worker until the returned promise is set, so loads queue up behind it.
+    std::shared_ptr<std::promise<void>> blockWorkers() {
+        auto gate = std::make_shared<std::promise<void>>();
+        std::shared_future<void> opened = gate->get_future().share();
+        std::vector<std::future<void>> started;
+        for (size_t i = 0; i < mace::AUDIO_LOADER_WORKERS; ++i) {
+            auto running = std::make_shared<std::promise<void>>();
+            started.push_back(running->get_future());
+            mace::AudioLoaderPool::Instance().Submit([running, opened]() {
+                running->set_value();
+                opened.wait();
+            });
+        }
+        for (auto &s : started) {
+            s.wait();
+        }
+        return gate;
+    }
+}
+
+TEST(TestAudioLoader, TestLoadAudio) {
+    mace::LoadedAudio audio = mace::LoadAudio(test_audio_path);
+    ASSERT_EQ(audio.status, AceClientStatus::OK);
+    EXPECT_EQ(audio.path, test_audio_path);
+    ASSERT_NE(audio.source, nullptr);
+    EXPECT_EQ(audio.source->GetSampleRate(), 16000);
+    EXPECT_EQ(audio.source->GetSampleCount(), 64000);
+
+    // downsampled while read
+    mace::WavFileAudioSource wav;
+    ASSERT_EQ(wav.Open(test_audio_48k_path), AceClientStatus::OK);
+    audio = mace::LoadAudio(test_audio_48k_path);
+    ASSERT_EQ(audio.status, AceClientStatus::OK);
+    EXPECT_EQ(audio.source->GetSampleRate(), 16000);
+    EXPECT_EQ(audio.source->GetSampleCount(), (wav.GetSampleCount() + 2) / 3);
+
+    audio = mace::LoadAudio("./sample_data/missing.wav");
+    EXPECT_EQ(audio.status, AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_EQ(audio.source, nullptr);
+}
+
+TEST(TestAudioLoader, TestLoadWavAsync) {
+    auto result = mace::LoadWavAsync(test_audio_path);
+    mace::LoadedAudio audio = result.get();
+    ASSERT_EQ(audio.status, AceClientStatus::OK);
+    EXPECT_EQ(audio.source->GetSampleCount(), 64000);
+
+    mace::LoadedAudio expected = mace::LoadAudio(test_audio_path);
+    std::vector<int16_t> samples(1000), expected_samples(1000);
+    audio.source->Read(32000, samples.data(), samples.size());
+    expected.source->Read(32000, expected_samples.data(), expected_samples.size());
+    EXPECT_EQ(samples, expected_samples);
+}
+
+TEST(TestAudioLoader, TestSupersede) {
+    mace::AudioLoader loader;
+    std::atomic<int> callbacks(0);
+    std::string loaded_path;
+    auto onLoaded = [&](mace::LoadedAudio const &audio) {
+        loaded_path = audio.path;
+        callbacks++;
+    };
+
+    auto gate = blockWorkers();
+    auto first = loader.Load(test_audio_48k_path, 16000, onLoaded);
+    auto second = loader.Load(test_audio_path, 16000, onLoaded);
+    gate->set_value();
+
+    EXPECT_EQ(first.get().status, AceClientStatus::ERROR_CANCELLED);
+    EXPECT_EQ(first.get().source, nullptr);
+    ASSERT_EQ(second.get().status, AceClientStatus::OK);
+    EXPECT_EQ(second.get().path, test_audio_path);
+    EXPECT_EQ(second.get().source->GetSampleCount(), 64000);
+
+    // the callback runs after the future is ready
+    mace::AudioLoader::Shutdown();
+    EXPECT_EQ(callbacks, 1);
+    EXPECT_EQ(loaded_path, test_audio_path);
+}
+
+TEST(TestAudioLoader, TestCancel) {
+    mace::AudioLoader loader;
+    auto gate = blockWorkers();
+    auto result = loader.Load(test_audio_path);
+    loader.Cancel();
+    gate->set_value();
+    EXPECT_EQ(result.get().status, AceClientStatus::ERROR_CANCELLED);
+
+    // a failed load is not cancelled
+    EXPECT_EQ(loader.Load("./sample_data/missing.wav").get().status, AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_EQ(loader.Load(test_audio_path).get().status, AceClientStatus::OK);
+}
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "aceclient/audio_registry.h"
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+using mace::AudioRegistry;
+
+namespace {
+    std::string const test_audio_path = "./sample_data/audio_4sec_16k_s16le.wav";
+    std::string const test_audio_48k_path = "./sample_data/audio_6sec_48k_s16le.wav";
+}
+
+TEST(TestAudioRegistry, TestShare) {
+    auto &registry = AudioRegistry::Instance();
+    registry.Clear();
+    registry.ResetStats();
+
+    mace::LoadedAudio first = registry.Get(test_audio_path);
+    ASSERT_EQ(first.status, AceClientStatus::OK);
+    EXPECT_EQ(first.source->GetSampleCount(), 64000);
+
+    // the same file through another path
+    mace::LoadedAudio second = registry.Get("./sample_data/../sample_data/audio_4sec_16k_s16le.wav");
+    ASSERT_EQ(second.status, AceClientStatus::OK);
+    EXPECT_EQ(second.source, first.source);
+
+    // another rate is another source
+    mace::LoadedAudio resampled = registry.Get(test_audio_48k_path, 16000);
+    mace::LoadedAudio original = registry.Get(test_audio_48k_path, 48000);
+    ASSERT_EQ(resampled.status, AceClientStatus::OK);
+    ASSERT_EQ(original.status, AceClientStatus::OK);
+    EXPECT_NE(resampled.source, original.source);
+    EXPECT_EQ(original.source->GetSampleRate(), 48000);
+
+    auto stats = registry.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.loads, 3);
+    EXPECT_EQ(stats.files, 3);
+
+    // released sources are loaded again
+    first = mace::LoadedAudio();
+    second = mace::LoadedAudio();
+    EXPECT_EQ(registry.GetStats().files, 2);
+    first = registry.Get(test_audio_path);
+    ASSERT_EQ(first.status, AceClientStatus::OK);
+    EXPECT_EQ(registry.GetStats().loads, 4);
+    EXPECT_EQ(registry.GetStats().reloads, 0);
+}
+
+TEST(TestAudioRegistry, TestChangedFile) {
+    auto &registry = AudioRegistry::Instance();
+    registry.Clear();
+    registry.ResetStats();
+
+    fs::path path = fs::temp_directory_path() / "test_audio_registry.wav";
+    fs::copy_file(test_audio_path, path, fs::copy_options::overwrite_existing);
+    mace::LoadedAudio first = registry.Get(path.u8string());
+    ASSERT_EQ(first.status, AceClientStatus::OK);
+    EXPECT_EQ(first.source->GetSampleCount(), 64000);
+    EXPECT_EQ(registry.Get(path.u8string()).source, first.source);
+
+    fs::copy_file(test_audio_48k_path, path, fs::copy_options::overwrite_existing);
+    mace::LoadedAudio changed = registry.Get(path.u8string());
+    ASSERT_EQ(changed.status, AceClientStatus::OK);
+    EXPECT_NE(changed.source->GetSampleCount(), 64000);
+    EXPECT_EQ(first.source->GetSampleCount(), 64000);
+
+    auto stats = registry.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.loads, 2);
+    EXPECT_EQ(stats.reloads, 1);
+    EXPECT_EQ(stats.files, 1);
+
+    first = mace::LoadedAudio();
+    changed = mace::LoadedAudio();
+    fs::remove(path);
+}
+
+TEST(TestAudioRegistry, TestRewriteWhileHeld) {
+    auto &registry = AudioRegistry::Instance();
+    registry.Clear();
+    registry.ResetStats();
+
+    fs::path path = fs::temp_directory_path() / "test_audio_registry_held.wav";
+    fs::copy_file(test_audio_48k_path, path, fs::copy_options::overwrite_existing);
+    mace::LoadedAudio held = registry.Get(path.u8string());
+    ASSERT_EQ(held.status, AceClientStatus::OK);
+    size_t const count = held.source->GetSampleCount();
+    std::vector<int16_t> before(count);
+    ASSERT_EQ(held.source->Read(0, before.data(), count), count);
+
+    // rewritten in place, then truncated, while the source is held
+    {
+        std::ifstream shorter(test_audio_path, std::ios::binary);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        ASSERT_TRUE(file.is_open());
+        file << shorter.rdbuf();
+    }
+    fs::resize_file(path, fs::file_size(path) / 2);
+
+    std::vector<int16_t> after(count);
+    ASSERT_EQ(held.source->Read(0, after.data(), count), count);
+    EXPECT_EQ(after, before);
+
+    mace::LoadedAudio changed = registry.Get(path.u8string());
+    ASSERT_EQ(changed.status, AceClientStatus::OK);
+    EXPECT_NE(changed.source, held.source);
+    EXPECT_LT(changed.source->GetSampleCount(), 64000);
+    EXPECT_EQ(registry.GetStats().reloads, 1);
+
+    held = mace::LoadedAudio();
+    changed = mace::LoadedAudio();
+    fs::remove(path);
+}
+
+TEST(TestAudioRegistry, TestMissingFile) {
+    auto &registry = AudioRegistry::Instance();
+    registry.Clear();
+    registry.ResetStats();
+
+    mace::LoadedAudio audio = registry.Get("./sample_data/missing.wav");
+    EXPECT_EQ(audio.status, AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_EQ(audio.source, nullptr);
+    EXPECT_EQ(registry.GetStats().files, 0);
+}
+
+TEST(TestAudioRegistry, TestLoader) {
+    auto &registry = AudioRegistry::Instance();
+    registry.Clear();
+
+    mace::LoadedAudio held = registry.Get(test_audio_path);
+    mace::AudioLoader loader;
+    EXPECT_FALSE(loader.GetUseRegistry());
+    EXPECT_NE(loader.Load(test_audio_path).get().source, held.source);
+    loader.SetUseRegistry(true);
+    EXPECT_EQ(loader.Load(test_audio_path).get().source, held.source);
+}
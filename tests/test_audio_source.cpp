@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "aceclient/audio.h"
+#include "aceclient/audio_source.h"
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string const test_audio_path = "./sample_data/audio_4sec_16k_s16le.wav";
+    std::string const test_audio_f32_path = "./sample_data/audio_4sec_16k_f32.wav";
+
+    void writeUint(std::ofstream &out, uint32_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    // A WAV file with a chunk before the format to check that chunks are skipped.
+    fs::path writeWav(std::string const &name, uint16_t format, uint16_t channels, uint32_t rate,
+        uint16_t bits, std::string const &data) {
+        fs::path path = fs::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary);
+        out.write("RIFF", 4);
+        writeUint(out, static_cast<uint32_t>(4 + 14 + 24 + 8 + data.size()), 4);
+        out.write("WAVE", 4);
+        out.write("LIST", 4);
+        writeUint(out, 5, 4);
+        out.write("abcde\0", 6);
+        out.write("fmt ", 4);
+        writeUint(out, 16, 4);
+        writeUint(out, format, 2);
+        writeUint(out, channels, 2);
+        writeUint(out, rate, 4);
+        writeUint(out, rate * channels * bits / 8, 4);
+        writeUint(out, channels * bits / 8, 2);
+        writeUint(out, bits, 2);
+        out.write("data", 4);
+        writeUint(out, static_cast<uint32_t>(data.size()), 4);
+        out.write(data.data(), data.size());
+        return path;
+    }
+
+    template <typename T>
+    std::string toBytes(std::vector<T> const &values) {
+        return std::string(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    }
+}
+
+TEST(TestAudioSource, TestMemoryAudioSource) {
+    std::vector<int16_t> samples = {1, 2, 3, 4, 5};
+    mace::MemoryAudioSource borrowed(samples.data(), samples.size());
+    EXPECT_EQ(borrowed.GetSampleRate(), DefaultSampleRate);
+    EXPECT_EQ(borrowed.GetSampleCount(), 5);
+    EXPECT_EQ(borrowed.GetSamples(), samples.data());
+
+    int16_t out[4] = {};
+    EXPECT_EQ(borrowed.Read(3, out, 4), 2);
+    EXPECT_EQ(out[0], 4);
+    EXPECT_EQ(out[1], 5);
+    EXPECT_EQ(borrowed.Read(5, out, 4), 0);
+
+    mace::MemoryAudioSource owned(std::vector<int16_t>(samples), 48000);
+    EXPECT_EQ(owned.GetSampleRate(), 48000);
+    EXPECT_NE(owned.GetSamples(), samples.data());
+    EXPECT_EQ(owned.GetSamples()[4], 5);
+
+    mace::AudioSourceRange range(borrowed, 1, 3);
+    EXPECT_EQ(range.GetSampleCount(), 3);
+    EXPECT_EQ(range.GetSamples(), samples.data() + 1);
+    EXPECT_EQ(range.Read(1, out, 4), 2);
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[1], 4);
+    EXPECT_EQ(mace::AudioSourceRange(borrowed, 4, 10).GetSampleCount(), 1);
+    EXPECT_EQ(mace::AudioSourceRange(borrowed, 10, 10).GetSampleCount(), 0);
+}
+
+TEST(TestAudioSource, TestWavFile) {
+    // the same samples as the decoder of the whole file
+    std::vector<int16_t> expected = convert_float_to_int16(get_file_wav_content(test_audio_path));
+    ASSERT_GT(expected.size(), 0);
+
+    mace::WavFileAudioSource wav;
+    ASSERT_EQ(wav.Open(test_audio_path), AceClientStatus::OK);
+    EXPECT_EQ(wav.GetSampleRate(), 16000);
+    EXPECT_EQ(wav.GetChannelCount(), 1);
+    EXPECT_EQ(wav.GetBitsPerSample(), 16);
+    ASSERT_EQ(wav.GetSampleCount(), expected.size());
+    ASSERT_NE(wav.GetSamples(), nullptr);
+
+    std::vector<int16_t> samples(expected.size());
+    for (size_t first = 0; first < samples.size(); first += 1000) {
+        wav.Read(first, samples.data() + first, 1000);
+    }
+    EXPECT_EQ(samples, expected);
+    EXPECT_EQ(std::memcmp(wav.GetSamples(), expected.data(), expected.size() * sizeof(int16_t)), 0);
+
+    mace::WavFileAudioSource f32;
+    ASSERT_EQ(f32.Open(test_audio_f32_path), AceClientStatus::OK);
+    EXPECT_TRUE(f32.IsFloat());
+    EXPECT_EQ(f32.GetSamples(), nullptr);
+    std::vector<int16_t> expected_f32 = convert_float_to_int16(get_file_wav_content(test_audio_f32_path));
+    std::vector<int16_t> samples_f32(f32.GetSampleCount());
+    EXPECT_EQ(f32.Read(0, samples_f32.data(), samples_f32.size()), expected_f32.size());
+    EXPECT_EQ(samples_f32, expected_f32);
+}
+
+TEST(TestAudioSource, TestWavFormats) {
+    // the second channel of stereo files in every supported format
+    std::vector<int16_t> pcm16 = {0, 100, 0, -200, 0, 32767, 0, -32768};
+    fs::path path = writeWav("mace_test_pcm16.wav", 1, 2, 16000, 16, toBytes(pcm16));
+    mace::WavFileAudioSource wav;
+    ASSERT_EQ(wav.Open(path.u8string(), 1), AceClientStatus::OK);
+    ASSERT_EQ(wav.GetSampleCount(), 4);
+    EXPECT_EQ(wav.GetSamples(), nullptr);
+    int16_t out[4];
+    wav.Read(0, out, 4);
+    EXPECT_EQ(std::vector<int16_t>(out, out + 4), std::vector<int16_t>({100, -200, 32767, -32768}));
+    EXPECT_EQ(wav.Open(path.u8string(), 2), AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_FALSE(wav.IsOpen());
+
+    std::vector<float> f32 = {0.0f, 0.5f, 0.0f, -0.25f, 0.0f, 2.0f, 0.0f, -2.0f};
+    path = writeWav("mace_test_f32.wav", 3, 2, 16000, 32, toBytes(f32));
+    ASSERT_EQ(wav.Open(path.u8string(), 1), AceClientStatus::OK);
+    wav.Read(0, out, 4);
+    // saturated on both sides
+    EXPECT_EQ(std::vector<int16_t>(out, out + 4), std::vector<int16_t>({16384, -8192, 32767, -32768}));
+
+    std::string pcm24 = std::string("\0\0\0\x00\x80\x00\0\0\0\x00\x00\x80", 12);
+    path = writeWav("mace_test_pcm24.wav", 1, 2, 16000, 24, pcm24);
+    ASSERT_EQ(wav.Open(path.u8string(), 1), AceClientStatus::OK);
+    ASSERT_EQ(wav.GetSampleCount(), 2);
+    wav.Read(0, out, 2);
+    EXPECT_EQ(out[0], 128);
+    EXPECT_EQ(out[1], -32768);
+
+    std::string pcm8 = std::string("\x80\xff\x80\x00", 4);
+    path = writeWav("mace_test_pcm8.wav", 1, 2, 16000, 8, pcm8);
+    ASSERT_EQ(wav.Open(path.u8string(), 1), AceClientStatus::OK);
+    wav.Read(0, out, 2);
+    EXPECT_EQ(out[0], 127 * 256);
+    EXPECT_EQ(out[1], -32768);
+
+    // 48k files are opened; the rate is checked by the user
+    path = writeWav("mace_test_48k.wav", 1, 1, 48000, 16, toBytes(pcm16));
+    ASSERT_EQ(wav.Open(path.u8string()), AceClientStatus::OK);
+    EXPECT_EQ(wav.GetSampleRate(), 48000);
+    EXPECT_EQ(wav.GetSampleCount(), 8);
+
+    path = writeWav("mace_test_alaw.wav", 6, 1, 16000, 8, pcm8);
+    EXPECT_EQ(wav.Open(path.u8string()), AceClientStatus::ERROR_INVALID_INPUT);
+    wav.Close();
+
+    for (auto name : {"mace_test_pcm16.wav", "mace_test_f32.wav", "mace_test_pcm24.wav", "mace_test_pcm8.wav",
+        "mace_test_48k.wav", "mace_test_alaw.wav"}) {
+        fs::remove(fs::temp_directory_path() / name);
+    }
+    EXPECT_EQ(wav.Open("./sample_data/missing.wav"), AceClientStatus::ERROR_INVALID_INPUT);
+}
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/animation.h"
+#include "aceclient/channel_pool.h"
+
+#include <gtest/gtest.h>
+
+using mace::ChannelPool;
+
+class TestChannelPool : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        ChannelPool::Instance().Clear();
+        ChannelPool::Instance().ResetStats();
+    }
+};
+
+TEST_F(TestChannelPool, TestAcquireReusesChannel) {
+    auto first = ChannelPool::Instance().Acquire("localhost:50051", false);
+    auto second = ChannelPool::Instance().Acquire("localhost:50051", false);
+
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->channel, second->channel);
+    EXPECT_EQ(first->a2fStub, second->a2fStub);
+    EXPECT_EQ(first->healthStub, second->healthStub);
+
+    auto stats = ChannelPool::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.entries, 1);
+}
+
+TEST_F(TestChannelPool, TestTlsModeIsPartOfKey) {
+    auto insecure = ChannelPool::Instance().Acquire("localhost:50051", false);
+    auto secured = ChannelPool::Instance().Acquire("localhost:50051", true);
+
+    EXPECT_NE(insecure->channel, secured->channel);
+
+    auto stats = ChannelPool::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.hits, 0);
+    EXPECT_EQ(stats.entries, 2);
+}
+
+TEST_F(TestChannelPool, TestInvalidate) {
+    auto first = ChannelPool::Instance().Acquire("localhost:50051", false);
+
+    EXPECT_TRUE(ChannelPool::Instance().Invalidate("localhost:50051", false));
+    EXPECT_FALSE(ChannelPool::Instance().Invalidate("localhost:50051", false));
+
+    auto second = ChannelPool::Instance().Acquire("localhost:50051", false);
+    EXPECT_NE(first->channel, second->channel);
+
+    auto stats = ChannelPool::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.invalidations, 1);
+}
+
+TEST_F(TestChannelPool, TestClientSettingsKeepSharedChannel) {
+    mace::AnimationClient client;
+    client.SetUrl("http://localhost:50051");
+    auto other = ChannelPool::Instance().Acquire("localhost:50051", false);
+
+    // the key and function are per call, and other clients may still use the previous url
+    client.SetAPIKey("__new_api_key__");
+    client.SetFunctionId("__new_function_id__");
+    client.SetUrl("http://localhost:50052");
+    EXPECT_EQ(ChannelPool::Instance().GetStats().invalidations, 0);
+    EXPECT_EQ(ChannelPool::Instance().Acquire("localhost:50051", false), other);
+}
+
+TEST_F(TestChannelPool, TestIdleExpiry) {
+    auto &pool = ChannelPool::Instance();
+    EXPECT_EQ(pool.GetIdleTTL(), mace::DEFAULT_CHANNEL_IDLE_TTL_MS);
+    pool.SetIdleTTL(0);
+
+    auto held = pool.Acquire("localhost:50051", false);
+    pool.Acquire("localhost:50052", false);
+    // released entries expire on the next acquire; held ones stay
+    pool.Acquire("localhost:50053", false);
+    EXPECT_EQ(pool.GetStats().entries, 2);
+    EXPECT_EQ(pool.Acquire("localhost:50051", false), held);
+    EXPECT_EQ(pool.GetStats().entries, 1);
+
+    pool.SetIdleTTL(mace::DEFAULT_CHANNEL_IDLE_TTL_MS);
+    held.reset();
+    pool.Acquire("localhost:50052", false);
+    EXPECT_EQ(pool.GetStats().entries, 2);
+}
+
+TEST_F(TestChannelPool, TestRepeatedRequestsShareChannel) {
+    /*Requires the mock server; see TestClient.TestRequestAnimation1.
+    */
+    std::vector<int16_t> samples(8320, 0);
+    mace::AnimationClient client1;
+    mace::AnimationClient client2;
+    client1.SetUrl("http://localhost:50051");
+    client2.SetUrl("http://localhost:50051");
+
+    std::vector<AnimDataFrame> frames;
+    ASSERT_EQ(client1.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    ASSERT_EQ(client1.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    ASSERT_EQ(client2.RequestAnimation(samples, &frames), AceClientStatus::OK);
+
+    auto stats = ChannelPool::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 2);
+}
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/clip_cache.h"
+
+#include <gtest/gtest.h>
+
+using mace::ClipCache;
+
+namespace {
+    std::shared_ptr<const mace::AnimationTrack> makeTrack(size_t frame_count) {
+        auto track = std::make_shared<mace::AnimationTrack>();
+        for (size_t i = 0; i < frame_count; ++i) {
+            AnimDataFrame frame;
+            frame.timestamp = i / 30.0;
+            frame.blend_shape_weights = std::vector<float>(52, 0.5f);
+            track->AddFrame(frame);
+        }
+        return track;
+    }
+
+    mace::RequestKey makeKey(uint64_t value) {
+        mace::RequestKey key;
+        key.audio = value;
+        return key;
+    }
+}
+
+class TestClipCache : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        ClipCache::Instance().Clear();
+        ClipCache::Instance().ResetStats();
+        ClipCache::Instance().SetBudget(mace::DEFAULT_CLIP_CACHE_BUDGET);
+    }
+
+    virtual void TearDown() {
+        ClipCache::Instance().Clear();
+        ClipCache::Instance().SetBudget(mace::DEFAULT_CLIP_CACHE_BUDGET);
+    }
+};
+
+TEST_F(TestClipCache, TestGetPut) {
+    auto &cache = ClipCache::Instance();
+    auto track = makeTrack(10);
+    EXPECT_EQ(cache.Get(makeKey(1)), nullptr);
+    cache.Put(makeKey(1), track);
+    EXPECT_EQ(cache.Get(makeKey(1)), track);
+    EXPECT_EQ(cache.Get(makeKey(2)), nullptr);
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.insertions, 1);
+    EXPECT_EQ(stats.clips, 1);
+    EXPECT_EQ(stats.bytes, track->GetMemoryUsage());
+
+    EXPECT_TRUE(cache.Remove(makeKey(1)));
+    EXPECT_FALSE(cache.Remove(makeKey(1)));
+    EXPECT_EQ(cache.GetStats().bytes, 0);
+}
+
+TEST_F(TestClipCache, TestEviction) {
+    auto &cache = ClipCache::Instance();
+    auto track = makeTrack(100);
+    size_t bytes = track->GetMemoryUsage();
+    cache.SetBudget(bytes * 2);
+
+    cache.Put(makeKey(1), track);
+    cache.Put(makeKey(2), makeTrack(100));
+    // 1 is now used more recently than 2
+    EXPECT_NE(cache.Get(makeKey(1)), nullptr);
+    cache.Put(makeKey(3), makeTrack(100));
+
+    EXPECT_EQ(cache.Get(makeKey(2)), nullptr);
+    EXPECT_NE(cache.Get(makeKey(1)), nullptr);
+    EXPECT_NE(cache.Get(makeKey(3)), nullptr);
+    EXPECT_EQ(cache.GetStats().evictions, 1);
+
+    // a track beyond the budget is not cached
+    cache.Put(makeKey(4), makeTrack(1000));
+    EXPECT_EQ(cache.Get(makeKey(4)), nullptr);
+    EXPECT_EQ(cache.GetStats().clips, 2);
+}
@@ -0,0 +1,197 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/disk_cache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "aceclient/animation_track.h"
+#include "aceclient/hash.h"
+#include "aceclient/mapped_file.h"
+
+#include <gtest/gtest.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    mace::AnimationTrack makeTrack(size_t frame_count, float value) {
+        mace::AnimationTrack track;
+        track.OnHeader({"a", "b"}, {"joy"});
+        for (size_t i = 0; i < frame_count; ++i) {
+            AnimDataFrame frame;
+            frame.timestamp = i / 30.0;
+            frame.blend_shape_weights = {value, static_cast<float>(i)};
+            if (i % 2 == 0) {
+                frame.emotion_state = {0.5f};
+            }
+            track.AddFrame(frame);
+        }
+        return track;
+    }
+
+    mace::RequestKey makeKey(uint64_t value) {
+        mace::RequestKey key;
+        key.audio = value;
+        key.parameters = ~value;
+        return key;
+    }
+
+    class TestDiskCache : public ::testing::Test {
+    protected:
+        std::string directory;
+
+        void SetUp() override {
+            directory = (fs::temp_directory_path() / "mace_test_disk_cache").u8string();
+            fs::remove_all(directory);
+        }
+
+        void TearDown() override {
+            fs::remove_all(directory);
+        }
+    };
+}
+
+TEST(TestHash, TestHash64) {
+    std::string text = "The quick brown fox jumps over the lazy dog";
+    EXPECT_EQ(mace::Hash64(text.data(), text.size()), mace::Hash64(text.data(), text.size()));
+    EXPECT_NE(mace::Hash64(text.data(), text.size()), mace::Hash64(text.data(), text.size() - 1));
+    EXPECT_NE(mace::Hash64(text.data(), text.size()), mace::Hash64(text.data(), text.size(), 1));
+    EXPECT_NE(mace::Hash64("", 0), mace::Hash64("\0", 1));
+
+    mace::RequestKey key = makeKey(0x0123456789abcdefULL);
+    EXPECT_EQ(key.ToString(), "0123456789abcdeffedcba9876543210");
+    EXPECT_EQ(key, makeKey(0x0123456789abcdefULL));
+    EXPECT_NE(key, makeKey(1));
+}
+
+TEST(TestMappedFile, TestOpen) {
+    fs::path path = fs::temp_directory_path() / "mace_test_mapped_file.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "mapped contents";
+    }
+    mace::MappedFile file;
+    ASSERT_TRUE(file.Open(path.u8string()));
+    EXPECT_EQ(std::string(file.GetData(), file.GetSize()), "mapped contents");
+    // the mapping survives the file
+    fs::remove(path);
+    EXPECT_EQ(std::string(file.GetData(), file.GetSize()), "mapped contents");
+    file.Close();
+    EXPECT_FALSE(file.IsOpen());
+    EXPECT_FALSE(file.Open(path.u8string()));
+}
+
+TEST(TestAnimationTrack, TestClip) {
+    mace::AnimationTrack track = makeTrack(10, 0.25f);
+    std::ostringstream out;
+    ASSERT_TRUE(track.WriteClip(out));
+    std::string clip = out.str();
+
+    mace::AnimationTrack loaded;
+    ASSERT_TRUE(loaded.ReadClip(clip.data(), clip.size()));
+    ASSERT_EQ(loaded.GetFramesCount(), 10);
+    EXPECT_EQ(loaded.GetBlendshapeNames(), track.GetBlendshapeNames());
+    EXPECT_EQ(loaded.GetEmotionStateNames(), track.GetEmotionStateNames());
+    EXPECT_TRUE(loaded.HasTimeIndex());
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(loaded.GetTimestamp(i), track.GetTimestamp(i));
+        EXPECT_EQ(loaded.GetBlendshapeWeights(i), track.GetBlendshapeWeights(i));
+        EXPECT_EQ(loaded.HasEmotionState(i), track.HasEmotionState(i));
+    }
+
+    // truncated or altered clips are rejected and leave the track as it was
+    EXPECT_FALSE(loaded.ReadClip(clip.data(), clip.size() - 1));
+    std::string altered = clip;
+    altered[0] = 'X';
+    EXPECT_FALSE(loaded.ReadClip(altered.data(), altered.size()));
+    EXPECT_EQ(loaded.GetFramesCount(), 10);
+}
+
+TEST_F(TestDiskCache, TestStoreLoad) {
+    mace::DiskCache cache(directory);
+    mace::AnimationTrack track;
+    EXPECT_FALSE(cache.Load(makeKey(1), &track));
+
+    ASSERT_TRUE(cache.Store(makeKey(1), makeTrack(30, 0.5f)));
+    ASSERT_TRUE(cache.Load(makeKey(1), &track));
+    EXPECT_EQ(track.GetFramesCount(), 30);
+    EXPECT_EQ(track.GetBlendshapeWeights(3), std::vector<float>({0.5f, 3.0f}));
+    EXPECT_FALSE(cache.Load(makeKey(2), &track));
+
+    // no temporary files are left behind
+    size_t files = 0;
+    for (auto const &entry : fs::directory_iterator(directory)) {
+        EXPECT_EQ(entry.path().extension(), ".clip");
+        files++;
+    }
+    EXPECT_EQ(files, 1);
+
+    mace::DiskCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.stores, 1);
+}
+
+TEST_F(TestDiskCache, TestInvalidClip) {
+    mace::DiskCache cache(directory);
+    ASSERT_TRUE(cache.Store(makeKey(1), makeTrack(30, 0.5f)));
+    {
+        std::ofstream out(fs::u8path(cache.GetPath(makeKey(1))), std::ios::binary | std::ios::trunc);
+        out << "not a clip";
+    }
+    mace::AnimationTrack track;
+    EXPECT_FALSE(cache.Load(makeKey(1), &track));
+    EXPECT_FALSE(fs::exists(fs::u8path(cache.GetPath(makeKey(1)))));
+}
+
+TEST_F(TestDiskCache, TestEviction) {
+    mace::DiskCache cache(directory);
+    ASSERT_TRUE(cache.Store(makeKey(1), makeTrack(100, 1.0f)));
+    uint64_t clipSize = cache.GetSize();
+    ASSERT_GT(clipSize, 0);
+    ASSERT_TRUE(cache.Store(makeKey(2), makeTrack(100, 2.0f)));
+    ASSERT_TRUE(cache.Store(makeKey(3), makeTrack(100, 3.0f)));
+
+    // clip 1 was used more recently than clip 2
+    auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    fs::last_write_time(fs::u8path(cache.GetPath(makeKey(1))), past);
+    fs::last_write_time(fs::u8path(cache.GetPath(makeKey(2))), past - std::chrono::minutes(1));
+    fs::last_write_time(fs::u8path(cache.GetPath(makeKey(3))), past - std::chrono::minutes(2));
+    mace::AnimationTrack track;
+    ASSERT_TRUE(cache.Load(makeKey(1), &track));
+
+    cache.SetMaxBytes(clipSize * 2);
+    EXPECT_EQ(cache.Trim(), 1);
+    EXPECT_FALSE(fs::exists(fs::u8path(cache.GetPath(makeKey(3)))));
+    EXPECT_TRUE(fs::exists(fs::u8path(cache.GetPath(makeKey(2)))));
+    EXPECT_TRUE(fs::exists(fs::u8path(cache.GetPath(makeKey(1)))));
+
+    // storing beyond the limit evicts the least recently used
+    ASSERT_TRUE(cache.Store(makeKey(4), makeTrack(100, 4.0f)));
+    EXPECT_FALSE(fs::exists(fs::u8path(cache.GetPath(makeKey(2)))));
+    EXPECT_LE(cache.GetSize(), clipSize * 2);
+    EXPECT_EQ(cache.GetStats().evictions, 2);
+
+    cache.Clear();
+    EXPECT_EQ(cache.GetSize(), 0);
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/frame_receiver.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+    std::vector<AnimDataFrame> makeFrames(std::vector<double> const &timestamps) {
+        std::vector<AnimDataFrame> frames(timestamps.size());
+        for (size_t i = 0; i < timestamps.size(); ++i) {
+            frames[i].timestamp = timestamps[i];
+        }
+        return frames;
+    }
+
+    class CountingReceiver : public mace::FrameCollector {
+    public:
+        CountingReceiver() : FrameCollector(&frames) {}
+
+        void OnHeader(std::vector<std::string> const &blend_shape_names,
+            std::vector<std::string> const &emotion_state_names) override {
+            headers++;
+        }
+        void OnComplete(AceClientStatus status) override {
+            completions++;
+        }
+
+        std::vector<AnimDataFrame> frames;
+        int headers = 0;
+        int completions = 0;
+    };
+}
+
+TEST(TestFrameReceiver, TestFrameCollector) {
+    std::vector<AnimDataFrame> frames;
+    mace::FrameCollector collector(&frames);
+    collector.OnFrames(makeFrames({0.0, 0.5}));
+    collector.OnFrames(makeFrames({1.0}));
+    ASSERT_EQ(frames.size(), 3);
+    EXPECT_DOUBLE_EQ(frames[2].timestamp, 1.0);
+}
+
+TEST(TestFrameReceiver, TestFrameSplicer) {
+    CountingReceiver receiver;
+    mace::FrameSplicer splicer(&receiver);
+    EXPECT_FALSE(splicer.HasFrames());
+    EXPECT_DOUBLE_EQ(splicer.GetResumeTime(1.0), 0.0);
+
+    splicer.OnHeader({"a"}, {});
+    splicer.OnFrames(makeFrames({0.0, 0.5, 1.0, 1.5, 2.0}));
+    splicer.OnComplete(AceClientStatus::ERROR_CONNECTION);
+    EXPECT_TRUE(splicer.HasFrames());
+    EXPECT_DOUBLE_EQ(splicer.GetResumeTime(0.7), 1.5);
+    EXPECT_DOUBLE_EQ(splicer.GetResumeTime(10.0), 0.0);
+
+    // the second attempt starts at 1.5s; its first two frames were already forwarded
+    splicer.SetTimeOffset(1.5);
+    splicer.OnHeader({"a"}, {});
+    splicer.OnFrames(makeFrames({0.0, 0.5, 1.0, 1.5}));
+
+    EXPECT_EQ(receiver.headers, 1);
+    EXPECT_EQ(receiver.completions, 0);
+    ASSERT_EQ(receiver.frames.size(), 7);
+    for (size_t i = 0; i < receiver.frames.size(); ++i) {
+        EXPECT_DOUBLE_EQ(receiver.frames[i].timestamp, i * 0.5);
+    }
+}
+
+TEST(TestFrameReceiver, TestFrameTee) {
+    CountingReceiver first;
+    CountingReceiver second;
+    mace::FrameTee tee(&first, &second);
+    tee.OnHeader({"a"}, {});
+    tee.OnFrames(makeFrames({0.0, 0.5}));
+    tee.OnComplete(AceClientStatus::OK);
+
+    EXPECT_EQ(first.headers, 1);
+    EXPECT_EQ(second.headers, 1);
+    EXPECT_EQ(first.frames.size(), 2);
+    EXPECT_EQ(second.frames.size(), 2);
+    EXPECT_EQ(second.completions, 0);
+}
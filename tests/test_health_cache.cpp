@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/animation.h"
+#include "aceclient/health_cache.h"
+
+#include <gtest/gtest.h>
+
+using mace::HealthCache;
+
+class TestHealthCache : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        HealthCache::Instance().Clear();
+        HealthCache::Instance().ResetStats();
+    }
+};
+
+TEST_F(TestHealthCache, TestMarkHealthy) {
+    auto &cache = HealthCache::Instance();
+    EXPECT_FALSE(cache.IsHealthy("localhost:50051", false, "key", "function", 1000));
+
+    cache.MarkHealthy("localhost:50051", false, "key", "function");
+    EXPECT_TRUE(cache.IsHealthy("localhost:50051", false, "key", "function", 1000));
+    // every part of the key counts
+    EXPECT_FALSE(cache.IsHealthy("localhost:50051", true, "key", "function", 1000));
+    EXPECT_FALSE(cache.IsHealthy("localhost:50051", false, "other_key", "function", 1000));
+    EXPECT_FALSE(cache.IsHealthy("localhost:50051", false, "key", "other_function", 1000));
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 4);
+}
+
+TEST_F(TestHealthCache, TestExpiry) {
+    auto &cache = HealthCache::Instance();
+    cache.MarkHealthy("localhost:50051", false, "", "");
+    EXPECT_FALSE(cache.IsHealthy("localhost:50051", false, "", "", 0));
+}
+
+TEST_F(TestHealthCache, TestInvalidate) {
+    auto &cache = HealthCache::Instance();
+    cache.MarkHealthy("localhost:50051", false, "", "");
+    EXPECT_TRUE(cache.Invalidate("localhost:50051", false, "", ""));
+    EXPECT_FALSE(cache.Invalidate("localhost:50051", false, "", ""));
+    EXPECT_FALSE(cache.IsHealthy("localhost:50051", false, "", "", 1000));
+}
+
+TEST_F(TestHealthCache, TestClientReusesHealthCheck) {
+    /*Requires the mock server; see TestClient.TestRequestAnimation1.
+    */
+    std::vector<int16_t> samples(8320, 0);
+    mace::AnimationClient client;
+    client.SetUrl("http://localhost:50051");
+    EXPECT_EQ(client.GetHealthCheckMode(), mace::HealthCheckCached);
+
+    std::vector<AnimDataFrame> frames;
+    ASSERT_EQ(client.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    ASSERT_EQ(client.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    auto stats = HealthCache::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 1);
+
+    // always check
+    client.SetHealthCheckMode(mace::HealthCheckAlways);
+    ASSERT_EQ(client.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    // never check
+    client.SetHealthCheckMode(mace::HealthCheckSkip);
+    ASSERT_EQ(client.RequestAnimation(samples, &frames), AceClientStatus::OK);
+    stats = HealthCache::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.hits, 1);
+}
+
+TEST_F(TestHealthCache, TestSkippedCheckReportsStreamErrors) {
+    std::vector<int16_t> samples(8320, 0);
+    mace::AnimationClient client;
+    client.SetUrl("http://127.0.0.1:50052");
+    client.SetHealthCheckMode(mace::HealthCheckSkip);
+
+    std::vector<AnimDataFrame> frames;
+    EXPECT_EQ(client.RequestAnimation(samples, &frames), AceClientStatus::ERROR_CONNECTION);
+}
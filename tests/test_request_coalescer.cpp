@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/request_coalescer.h"
+
+#include <gtest/gtest.h>
+
+using mace::RequestCoalescer;
+
+namespace {
+    mace::RequestKey makeKey(uint64_t value) {
+        mace::RequestKey key;
+        key.audio = value;
+        return key;
+    }
+}
+
+TEST(TestRequestCoalescer, TestJoinComplete) {
+    auto &coalescer = RequestCoalescer::Instance();
+    coalescer.ResetStats();
+
+    std::shared_future<mace::CoalescedResult> leader, follower, other;
+    EXPECT_TRUE(coalescer.Join(makeKey(1), &leader));
+    EXPECT_FALSE(coalescer.Join(makeKey(1), &follower));
+    EXPECT_TRUE(coalescer.Join(makeKey(2), &other));
+    EXPECT_EQ(coalescer.GetStats().inFlight, 2);
+
+    mace::CoalescedResult result;
+    result.status = AceClientStatus::OK;
+    result.track = std::make_shared<mace::AnimationTrack>();
+    coalescer.Complete(makeKey(1), result);
+    ASSERT_EQ(follower.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(follower.get().status, AceClientStatus::OK);
+    EXPECT_EQ(follower.get().track, result.track);
+    EXPECT_EQ(other.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+    // the completed key starts a new request
+    std::shared_future<mace::CoalescedResult> again;
+    EXPECT_TRUE(coalescer.Join(makeKey(1), &again));
+
+    mace::CoalescedResult failed;
+    failed.status = AceClientStatus::ERROR_CONNECTION;
+    coalescer.Complete(makeKey(1), failed);
+    coalescer.Complete(makeKey(2), failed);
+    EXPECT_EQ(again.get().status, AceClientStatus::ERROR_CONNECTION);
+    EXPECT_EQ(other.get().track, nullptr);
+
+    auto stats = coalescer.GetStats();
+    EXPECT_EQ(stats.leaders, 3);
+    EXPECT_EQ(stats.followers, 1);
+    EXPECT_EQ(stats.inFlight, 0);
+}
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/channel_pool.h"
+#include "aceclient/request_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using mace::AnimationJob;
+using mace::AnimationJobResult;
+using mace::ChannelPool;
+using mace::RequestScheduler;
+
+// Records how many jobs run at the same time instead of sending them.
+class CountingScheduler : public RequestScheduler {
+public:
+    using RequestScheduler::RequestScheduler;
+
+    std::atomic<int> running{0};
+    std::atomic<int> maxRunning{0};
+
+    bool GetCoalesceRequests() {
+        return m_client.GetCoalesceRequests();
+    }
+
+protected:
+    AnimationJobResult runJob(AnimationJob const &job) override {
+        int current = ++running;
+        int previous = maxRunning.load();
+        while (current > previous && !maxRunning.compare_exchange_weak(previous, current)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --running;
+
+        AnimationJobResult result;
+        result.status = AceClientStatus::OK;
+        result.frames.resize(job.samples.size());
+        return result;
+    }
+};
+
+TEST(TestRequestScheduler, TestConcurrencyLimit) {
+    CountingScheduler scheduler(3);
+    std::vector<AnimationJob> jobs(10);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].samples.resize(i);
+    }
+
+    auto results = scheduler.Run(jobs);
+
+    ASSERT_EQ(results.size(), jobs.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].status, AceClientStatus::OK);
+        // results keep the order of the jobs
+        EXPECT_EQ(results[i].frames.size(), i);
+    }
+    EXPECT_GT(scheduler.maxRunning, 1);
+    EXPECT_LE(scheduler.maxRunning, 3);
+}
+
+TEST(TestRequestScheduler, TestSettings) {
+    // the jobs run on copies of the client, so they coalesce too
+    EXPECT_TRUE(CountingScheduler().GetCoalesceRequests());
+
+    RequestScheduler scheduler(0);
+    EXPECT_EQ(scheduler.GetMaxConcurrency(), 1);
+    EXPECT_TRUE(scheduler.Run({}).empty());
+    EXPECT_EQ(scheduler.SetUrl("localhost:50051"), AceClientStatus::ERROR_INVALID_INPUT);
+    EXPECT_EQ(scheduler.SetUrl("http://localhost:50051"), AceClientStatus::OK);
+    EXPECT_EQ(scheduler.GetUrl(), "http://localhost:50051");
+}
+
+TEST(TestRequestScheduler, TestRunRequests) {
+    /*Requires the mock server; see TestClient.TestRequestAnimation1.
+    */
+    ChannelPool::Instance().Clear();
+    ChannelPool::Instance().ResetStats();
+
+    RequestScheduler scheduler(4);
+    scheduler.SetUrl("http://localhost:50051");
+    std::vector<AnimationJob> jobs(6);
+    for (auto &job : jobs) {
+        job.samples.resize(8320, 0);
+    }
+    jobs[1].blendshapeMultipliers["JawOpen"] = 2.0f;
+
+    auto results = scheduler.Run(jobs);
+
+    ASSERT_EQ(results.size(), jobs.size());
+    for (auto &result : results) {
+        EXPECT_EQ(result.status, AceClientStatus::OK);
+        EXPECT_GT(result.frames.size(), 0);
+    }
+    // all streams went through one channel
+    auto stats = ChannelPool::Instance().GetStats();
+    EXPECT_EQ(stats.misses, 1);
+    EXPECT_EQ(stats.entries, 1);
+}
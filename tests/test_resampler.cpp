@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "aceclient/audio.h"
+#include "aceclient/audio_source.h"
+#include "aceclient/resampler.h"
+#include "utils.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+    const double PI = 3.14159265358979323846;
+}
+
+TEST(TestResampler, TestFilterBank) {
+    mace::PolyphaseResampler down(44100, 16000);
+    EXPECT_EQ(down.GetPhaseCount(), 160);
+    EXPECT_EQ(down.GetOutputCount(441), 160);
+    EXPECT_EQ(down.GetOutputCount(442), 161);
+
+    // integer ratios need a single filter
+    mace::PolyphaseResampler decimate(48000, 16000);
+    EXPECT_EQ(decimate.GetPhaseCount(), 1);
+    EXPECT_EQ(decimate.GetOutputCount(275925), 91975);
+    // the filter is as wide in time for every ratio of the same target
+    EXPECT_NEAR(static_cast<double>(down.GetTapCount()) / 44100, static_cast<double>(decimate.GetTapCount()) / 48000, 1e-4);
+
+    // rates without a small common divisor use the nearest of a limited number of phases
+    mace::PolyphaseResampler odd(44101, 16000);
+    EXPECT_EQ(odd.GetPhaseCount(), mace::RESAMPLER_MAX_PHASES);
+}
+
+TEST(TestResampler, TestBlocks) {
+    // any split into blocks gives the same samples as the whole
+    std::vector<float> input(10000);
+    FillRandom(input);
+    mace::PolyphaseResampler resampler(44100, 16000);
+    std::vector<float> whole(resampler.GetOutputCount(input.size()));
+    resampler.Process(input.data(), 0, input.size(), 0, whole.size(), whole.data());
+
+    for (size_t block : {1, 7, 160, 1000}) {
+        std::vector<float> blocks(whole.size());
+        for (size_t first = 0; first < blocks.size(); first += block) {
+            size_t count = std::min(block, blocks.size() - first);
+            int64_t inputFirst, inputLast;
+            resampler.GetInputRange(first, count, &inputFirst, &inputLast);
+            inputFirst = std::max<int64_t>(inputFirst, 0);
+            inputLast = std::min<int64_t>(inputLast, input.size());
+            resampler.Process(input.data() + inputFirst, inputFirst, inputLast - inputFirst, first, count, blocks.data() + first);
+        }
+        EXPECT_EQ(blocks, whole) << block;
+    }
+}
+
+TEST(TestResampler, TestResampledAudioSource) {
+    std::vector<int16_t> samples(44100);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i] = static_cast<int16_t>(16000.0 * std::sin(2.0 * PI * 440.0 * i / 44100));
+    }
+    auto source = std::make_shared<mace::MemoryAudioSource>(std::vector<int16_t>(samples), 44100);
+    mace::ResampledAudioSource resampled(source);
+    EXPECT_EQ(resampled.GetSampleRate(), DefaultSampleRate);
+    ASSERT_EQ(resampled.GetSampleCount(), 16000);
+    EXPECT_EQ(resampled.GetSamples(), nullptr);
+
+    std::vector<int16_t> whole(resampled.GetSampleCount());
+    EXPECT_EQ(resampled.Read(0, whole.data(), whole.size() + 10), whole.size());
+    for (size_t i = 100; i < whole.size() - 100; ++i) {
+        ASSERT_NEAR(whole[i], 16000.0 * std::sin(2.0 * PI * 440.0 * i / 16000), 20.0) << i;
+    }
+
+    // reading in chunks, like the upload does, gives the same samples
+    std::vector<int16_t> chunks(whole.size());
+    for (size_t first = 0; first < chunks.size(); first += 1234) {
+        resampled.Read(first, chunks.data() + first, std::min<size_t>(1234, chunks.size() - first));
+    }
+    EXPECT_EQ(chunks, whole);
+}
+
+TEST(TestResampler, TestResampledAudioSourceHash) {
+    std::vector<int16_t> samples(44100, 3);
+    auto source = std::make_shared<mace::MemoryAudioSource>(std::vector<int16_t>(samples), 44100);
+    mace::MemoryAudioSource same(samples.data(), samples.size(), 44100);
+    EXPECT_EQ(source->GetContentHash(), same.GetContentHash());
+
+    // the source and the rates are hashed rather than the resampled samples
+    mace::ResampledAudioSource resampled(source);
+    EXPECT_EQ(resampled.GetContentHash(), mace::ResampledAudioSource(source).GetContentHash());
+    EXPECT_NE(resampled.GetContentHash(), source->GetContentHash());
+    EXPECT_NE(resampled.GetContentHash(), mace::ResampledAudioSource(source, 22050).GetContentHash());
+    samples[100] = 4;
+    auto changed = std::make_shared<mace::MemoryAudioSource>(std::vector<int16_t>(samples), 44100);
+    EXPECT_NE(resampled.GetContentHash(), mace::ResampledAudioSource(changed).GetContentHash());
+}
+
+TEST(TestResampler, BenchmarkResample) {
+    // ten seconds of 44.1kHz audio to the rate of the service
+    std::vector<float> input(441000);
+    FillRandom(input);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> output = resample(input, 16000, 44100);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Resampling 10s from 44.1kHz to 16kHz: " << elapsed << " ms" << std::endl;
+    EXPECT_EQ(output.size(), 160000);
+}
@@ -0,0 +1,251 @@
+// SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+// SPDX-License-Identifier: MIT
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "aceclient/simd.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <iostream>
+#include <vector>
+
+#include "utils.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+    const mace::SimdLevel ALL_LEVELS[] = {mace::SimdScalar, mace::SimdSSE, mace::SimdAVX2, mace::SimdNEON};
+
+    std::vector<float> lerpReference(std::vector<float> const &left, std::vector<float> const &right, float t) {
+        std::vector<float> result;
+        for (size_t i = 0; i < left.size(); ++i) {
+            result.push_back(left[i] * (1.0 - t) + right[i] * t);
+        }
+        return result;
+    }
+}
+
+TEST(TestSimd, TestSimdLevel) {
+    mace::SimdLevel level = mace::GetSimdLevel();
+    std::cout << "SIMD level: " << mace::GetSimdLevelName(level) << std::endl;
+    EXPECT_TRUE(mace::IsSimdLevelSupported(level));
+    EXPECT_TRUE(mace::IsSimdLevelSupported(mace::SimdScalar));
+}
+
+TEST(TestSimd, TestLerp) {
+    // sizes around the vector widths exercise the remainders
+    for (size_t count : {0, 1, 3, 4, 7, 8, 9, 17, 52, 255}) {
+        std::vector<float> left(count);
+        std::vector<float> right(count);
+        FillRandom(left);
+        FillRandom(right);
+        std::vector<float> expected = lerpReference(left, right, 0.3f);
+
+        for (mace::SimdLevel level : ALL_LEVELS) {
+            if (!mace::IsSimdLevelSupported(level)) {
+                continue;
+            }
+            std::vector<float> out(count, -1.0f);
+            mace::Lerp(level, left.data(), right.data(), 0.3f, out.data(), count);
+            for (size_t i = 0; i < count; ++i) {
+                EXPECT_NEAR(out[i], expected[i], 1e-6f) << mace::GetSimdLevelName(level) << " at " << i;
+            }
+        }
+
+        // in place, with the dispatched kernel
+        std::vector<float> out = left;
+        mace::Lerp(out.data(), right.data(), 0.3f, out.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_NEAR(out[i], expected[i], 1e-6f);
+        }
+    }
+}
+
+TEST(TestSimd, TestLerpEnds) {
+    std::vector<float> left = {0.1f, 0.2f, 0.3f, 0.4f, 0.5f};
+    std::vector<float> right = {1.1f, 1.2f, 1.3f, 1.4f, 1.5f};
+    std::vector<float> out(left.size());
+    mace::Lerp(left.data(), right.data(), 0.0f, out.data(), out.size());
+    EXPECT_EQ(out, left);
+    mace::Lerp(left.data(), right.data(), 1.0f, out.data(), out.size());
+    EXPECT_EQ(out, right);
+}
+
+TEST(TestSimd, TestDot) {
+    for (size_t count : {0, 1, 3, 4, 7, 8, 9, 16, 17, 33, 148}) {
+        std::vector<float> a(count);
+        std::vector<float> b(count);
+        FillRandom(a);
+        FillRandom(b);
+        double expected = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            expected += static_cast<double>(a[i]) * b[i];
+        }
+
+        for (mace::SimdLevel level : ALL_LEVELS) {
+            if (!mace::IsSimdLevelSupported(level)) {
+                continue;
+            }
+            EXPECT_NEAR(mace::Dot(level, a.data(), b.data(), count), expected, 1e-4) << mace::GetSimdLevelName(level);
+        }
+        EXPECT_NEAR(mace::Dot(a.data(), b.data(), count), expected, 1e-4);
+    }
+}
+
+TEST(TestSimd, TestFloatToInt16) {
+    // the scale, both bounds, truncation toward zero and values beyond the int32 range
+    std::vector<float> edges = {0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 0.99999f, -0.99999f, 1e-6f, -1e-6f,
+        2.0f, -2.0f, 1e20f, -1e20f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(), 3.0f / 32768.0f, -3.5f / 32768.0f};
+    std::vector<int16_t> expected = {0, 16384, -16384, 32767, -32768, 32767, -32767, 0, 0,
+        32767, -32768, 32767, -32768, 32767, -32768, -32768, 3, -3};
+
+    for (size_t count : {0, 1, 7, 8, 9, 15, 16, 17, 255}) {
+        std::vector<float> input(count);
+        std::vector<int16_t> reference(count);
+        for (size_t i = 0; i < count; ++i) {
+            input[i] = edges[(i * 7) % edges.size()];
+            reference[i] = expected[(i * 7) % edges.size()];
+        }
+        for (mace::SimdLevel level : ALL_LEVELS) {
+            if (!mace::IsSimdLevelSupported(level)) {
+                continue;
+            }
+            std::vector<int16_t> out(count, 1);
+            mace::FloatToInt16(level, input.data(), out.data(), count);
+            EXPECT_EQ(out, reference) << mace::GetSimdLevelName(level) << " with " << count;
+        }
+        std::vector<int16_t> out(count, 1);
+        mace::FloatToInt16(input.data(), out.data(), count);
+        EXPECT_EQ(out, reference);
+    }
+}
+
+TEST(TestSimd, TestInt16ToFloat) {
+    // every int16 value converts exactly and back
+    std::vector<int16_t> input(65536 + 3);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<int16_t>(static_cast<int>(i % 65536) - 32768);
+    }
+    for (mace::SimdLevel level : ALL_LEVELS) {
+        if (!mace::IsSimdLevelSupported(level)) {
+            continue;
+        }
+        std::vector<float> out(input.size());
+        mace::Int16ToFloat(level, input.data(), out.data(), input.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            ASSERT_EQ(out[i], input[i] / 32768.0f) << mace::GetSimdLevelName(level) << " at " << i;
+        }
+        std::vector<int16_t> back(input.size());
+        mace::FloatToInt16(level, out.data(), back.data(), out.size());
+        EXPECT_EQ(back, input) << mace::GetSimdLevelName(level);
+    }
+}
+
+TEST(TestSimd, BenchmarkConvert) {
+    // one minute of 16kHz audio
+    const size_t SAMPLE_COUNT = 16000 * 60;
+    const size_t ITERATIONS = 20;
+    std::vector<float> samples_f(SAMPLE_COUNT);
+    FillRandom(samples_f);
+    std::vector<int16_t> samples(SAMPLE_COUNT);
+
+    auto report = [&](const char *name, auto &&convert) {
+        long long checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            checksum += convert();
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Conversion of " << SAMPLE_COUNT << " samples, " << name << ": "
+                  << elapsed / ITERATIONS << " ms (checksum " << checksum << ")" << std::endl;
+    };
+
+    // the loop of convert_float_to_int16 before the kernels
+    report("float to int16, push_back", [&]() {
+        std::vector<int16_t> output;
+        for (float sample : samples_f) {
+            output.push_back(static_cast<int16_t>(std::min(32767.0f, sample * 32768.0f)));
+        }
+        return static_cast<long long>(output[SAMPLE_COUNT / 2]);
+    });
+    for (mace::SimdLevel level : ALL_LEVELS) {
+        if (!mace::IsSimdLevelSupported(level)) {
+            continue;
+        }
+        std::string name = std::string("float to int16, ") + mace::GetSimdLevelName(level);
+        report(name.c_str(), [&]() {
+            mace::FloatToInt16(level, samples_f.data(), samples.data(), SAMPLE_COUNT);
+            return static_cast<long long>(samples[SAMPLE_COUNT / 2]);
+        });
+    }
+    for (mace::SimdLevel level : ALL_LEVELS) {
+        if (!mace::IsSimdLevelSupported(level)) {
+            continue;
+        }
+        std::string name = std::string("int16 to float, ") + mace::GetSimdLevelName(level);
+        report(name.c_str(), [&]() {
+            mace::Int16ToFloat(level, samples.data(), samples_f.data(), SAMPLE_COUNT);
+            return static_cast<long long>(samples_f[SAMPLE_COUNT / 2] * 32768.0f);
+        });
+    }
+}
+
+TEST(TestSimd, BenchmarkLerp) {
+    // a custom rig of 256 blendshapes, sampled for 50 characters over 200 frames
+    const size_t BLENDSHAPE_COUNT = 256;
+    const size_t ITERATIONS = 50 * 200;
+    std::vector<float> left(BLENDSHAPE_COUNT);
+    std::vector<float> right(BLENDSHAPE_COUNT);
+    FillRandom(left);
+    FillRandom(right);
+    std::vector<float> out(BLENDSHAPE_COUNT);
+
+    auto report = [&](const char *name, auto &&sample) {
+        float checksum = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            checksum += sample(static_cast<float>(i % 100) / 100.0f);
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Lerp of " << BLENDSHAPE_COUNT << " weights, " << name << ": "
+                  << elapsed / ITERATIONS << " ns (checksum " << checksum << ")" << std::endl;
+    };
+
+    // the loop of AnimationClient::GetBlendshapeWeights(float) before the kernel
+    report("push_back", [&](float t) {
+        std::vector<float> result;
+        for (size_t i = 0; i < right.size(); i++) {
+            result.push_back(right[i] * t + left[i] * (1.0 - t));
+        }
+        return result[0];
+    });
+    for (mace::SimdLevel level : ALL_LEVELS) {
+        if (!mace::IsSimdLevelSupported(level)) {
+            continue;
+        }
+        report(mace::GetSimdLevelName(level), [&](float t) {
+            mace::Lerp(level, left.data(), right.data(), t, out.data(), out.size());
+            return out[0];
+        });
+    }
+}
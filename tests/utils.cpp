@@ -20,12 +20,62 @@
 // SOFTWARE.
 #include "utils.h"
 
+#include <atomic>
 #include <cstdlib>
+#include <new>
 #include <vector>
 
+namespace {
+  std::atomic<int> counters(0);
+  std::atomic<size_t> allocations(0);
+}
+
+void *operator new(std::size_t size) {
+  if (counters.load(std::memory_order_relaxed) > 0) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
 void FillRandom(std::vector<float> &data) {
   for (unsigned int t = 0; t < data.size(); ++t) {
     data[t] =
         static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) - 0.5f;
   }
 }
+
+AllocationCounter::AllocationCounter() : m_start(allocations.load()) {
+  counters++;
+}
+
+AllocationCounter::~AllocationCounter() {
+  counters--;
+}
+
+size_t AllocationCounter::GetCount() const {
+  return allocations.load() - m_start;
+}
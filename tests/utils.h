@@ -20,6 +20,20 @@
 // SOFTWARE.
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 void FillRandom(std::vector<float> &data);
+
+// Counts the allocations made through the global operator new during its lifetime.
+// Allocations of every thread are counted, so keep other work idle while it is alive.
+class AllocationCounter {
+public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  size_t GetCount() const;
+
+private:
+  size_t m_start;
+};